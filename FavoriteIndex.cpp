@@ -0,0 +1,56 @@
+#include "FavoriteIndex.h"
+
+namespace {
+
+uint32_t hashId(std::string_view id) {
+    uint32_t hash = 2166136261u;    // FNV-1a
+    for (unsigned char c : id) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+}
+
+FavoriteIndex::FavoriteIndex(const std::vector<std::string>& ids) {
+    size_t bytes = 0;
+    for (const auto& id : ids) bytes += id.size();
+    m_blob.reserve(bytes);
+    m_offsets.reserve(ids.size() + 1);
+
+    m_offsets.push_back(0);
+    for (const auto& id : ids) {
+        m_blob += id;
+        m_offsets.push_back(static_cast<uint32_t>(m_blob.size()));
+    }
+
+    // Power of two with a load factor of at most 1/2
+    size_t slotCount = 16;
+    while (slotCount < ids.size() * 2) slotCount *= 2;
+    m_slots.assign(slotCount, 0);
+    m_hashes.assign(slotCount, 0);
+
+    size_t mask = slotCount - 1;
+    for (uint32_t i = 0; i < ids.size(); ++i) {
+        uint32_t hash = hashId(idAt(i));
+        size_t slot = hash & mask;
+        while (m_slots[slot] != 0) {
+            if (m_hashes[slot] == hash && idAt(m_slots[slot] - 1) == idAt(i)) break;  // duplicate id
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = i + 1;
+        m_hashes[slot] = hash;
+    }
+}
+
+bool FavoriteIndex::contains(std::string_view id) const {
+    if (m_slots.empty()) return false;
+
+    uint32_t hash = hashId(id);
+    size_t mask = m_slots.size() - 1;
+    for (size_t slot = hash & mask; m_slots[slot] != 0; slot = (slot + 1) & mask) {
+        if (m_hashes[slot] == hash && idAt(m_slots[slot] - 1) == id) return true;
+    }
+    return false;
+}
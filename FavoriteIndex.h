@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Immutable set of imdb ids with open addressing over one packed blob.
+// Built once per change of the favorites and then only read, so any
+// number of threads can query a published instance without locking.
+class FavoriteIndex {
+public:
+    FavoriteIndex() = default;
+    explicit FavoriteIndex(const std::vector<std::string>& ids);
+
+    bool contains(std::string_view id) const;
+    size_t size() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+
+private:
+    std::string_view idAt(uint32_t index) const {
+        return std::string_view(m_blob.data() + m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+    }
+
+    std::string m_blob;                 // all ids back to back
+    std::vector<uint32_t> m_offsets;    // id i is [offsets[i], offsets[i + 1])
+    std::vector<uint32_t> m_slots;      // id index + 1, 0 = empty
+    std::vector<uint32_t> m_hashes;     // hash per slot, compared before the text
+};
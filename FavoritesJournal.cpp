@@ -0,0 +1,82 @@
+#include "FavoritesJournal.h"
+#include "FileUtil.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+FavoritesJournal::FavoritesJournal(const std::string& path) : m_path(path) {}
+
+FavoritesJournal::~FavoritesJournal() {
+    close();
+}
+
+bool FavoritesJournal::open() {
+    if (!m_file) {
+        m_file = fopen(m_path.c_str(), "ab");
+    }
+    return m_file != nullptr;
+}
+
+void FavoritesJournal::close() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool FavoritesJournal::append(const std::vector<std::string>& records) {
+    if (records.empty()) return true;
+    if (!open()) return false;
+
+    std::string batch;
+    if (m_torn) batch += '\n';    // ends the fragment, replay skips it as a damaged record
+    for (const auto& record : records) {
+        batch += record;
+        batch += '\n';
+    }
+    bool written = fwrite(batch.data(), 1, batch.size(), m_file) == batch.size();
+    written = syncFile(m_file) && written;
+    m_torn = !written;
+    if (!written) close();   // reopened by the retry
+    return written;
+}
+
+void FavoritesJournal::reset() {
+    close();
+    m_torn = false;
+    FILE* file = fopen(m_path.c_str(), "wb");
+    if (file) {
+        syncFile(file);
+        fclose(file);
+    }
+}
+
+size_t FavoritesJournal::replay(const std::function<void(const std::string&)>& apply) {
+    close();
+
+    std::ifstream in(m_path, std::ios::binary);
+    if (!in.is_open()) return 0;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    in.close();
+    const std::string data = buffer.str();
+
+    size_t count = 0;
+    size_t start = 0;
+    for (size_t end = data.find('\n'); end != std::string::npos; end = data.find('\n', start)) {
+        if (end > start) {
+            apply(data.substr(start, end - start));
+            ++count;
+        }
+        start = end + 1;
+    }
+
+    if (start < data.size()) {
+        // No newline after the last record, the write never finished
+        std::error_code ec;
+        fs::resize_file(m_path, start, ec);
+    }
+    return count;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Append-only log of favorites changes next to the snapshot file.
+// One record per line, every batch is one write and one fsync, so a
+// toggle costs O(1) I/O. Not thread safe, MovieFavorites serializes it.
+class FavoritesJournal {
+public:
+    explicit FavoritesJournal(const std::string& path);
+    ~FavoritesJournal();
+
+    // false on a failed write or fsync, the caller keeps the records and
+    // appends them again (records are idempotent)
+    bool append(const std::vector<std::string>& records);
+    void reset();   // empty the log, after its records went into a snapshot
+
+    // Calls apply for every complete record in file order. A torn last
+    // record (crash during a write) is cut off. Returns the record count.
+    size_t replay(const std::function<void(const std::string&)>& apply);
+
+    const std::string& path() const { return m_path; }
+
+private:
+    bool open();
+    void close();
+
+    std::string m_path;
+    FILE* m_file = nullptr;
+    bool m_torn = false;    // the last append failed, it may have left part of a line
+};
@@ -0,0 +1,200 @@
+#include "FavoritesSnapshot.h"
+#include "FileUtil.h"
+#include <cstring>
+#include <fstream>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+struct SnapshotHeader {
+    char magic[4];          // "OFS1"
+    uint32_t count;
+    uint32_t fieldCount;    // kFieldCount, lets a reader reject other layouts
+    uint32_t reserved;
+    uint64_t blobSize;
+};
+
+// Per movie: offset and length of every field in the blob, then flags
+struct SnapshotRecord {
+    uint32_t offsets[12];
+    uint32_t lengths[12];
+    uint32_t flags;
+};
+
+const char kMagic[4] = { 'O', 'F', 'S', '1' };
+const uint32_t kFieldCount = 12;
+const uint32_t kHasDetails = 1;
+
+}
+
+Movie MovieView::toMovie() const {
+    Movie movie;
+    movie.title = std::string(title);
+    movie.year = std::string(year);
+    movie.imdb_id = std::string(imdb_id);
+    movie.actors = std::string(actors);
+    movie.poster_url = std::string(poster_url);
+    movie.plot = std::string(plot);
+    movie.rating = std::string(rating);
+    movie.director = std::string(director);
+    movie.genre = std::string(genre);
+    movie.runtime = std::string(runtime);
+    movie.type = std::string(type);
+    movie.released = std::string(released);
+    movie.hasDetails = hasDetails;
+    return movie;
+}
+
+bool FavoritesSnapshot::open(const std::string& path) {
+    close();
+    m_file = MappedFile(path);
+    if (!m_file.isOpen() || m_file.size() < sizeof(SnapshotHeader)) {
+        close();
+        return false;
+    }
+
+    SnapshotHeader header;
+    memcpy(&header, m_file.data(), sizeof(header));
+    uint64_t expected = sizeof(SnapshotHeader) + uint64_t(header.count) * sizeof(SnapshotRecord) + header.blobSize;
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.fieldCount != kFieldCount ||
+        header.blobSize > m_file.size() || expected != m_file.size()) {
+        close();
+        return false;
+    }
+
+    const char* records = m_file.data() + sizeof(SnapshotHeader);
+
+    // at() trusts the offsets, so a corrupt record rejects the whole file once here
+    for (uint32_t m = 0; m < header.count; ++m) {
+        SnapshotRecord record;
+        memcpy(&record, records + size_t(m) * sizeof(SnapshotRecord), sizeof(record));
+        for (uint32_t i = 0; i < kFieldCount; ++i) {
+            if (uint64_t(record.offsets[i]) + record.lengths[i] > header.blobSize) {
+                close();
+                return false;
+            }
+        }
+    }
+
+    m_count = header.count;
+    m_records = records;
+    m_blob = m_records + m_count * sizeof(SnapshotRecord);
+    return true;
+}
+
+void FavoritesSnapshot::close() {
+    m_file = MappedFile();
+    m_records = nullptr;
+    m_blob = nullptr;
+    m_count = 0;
+}
+
+MovieView FavoritesSnapshot::at(size_t index) const {
+    SnapshotRecord record;
+    memcpy(&record, m_records + index * sizeof(SnapshotRecord), sizeof(record));   // no alignment assumptions
+
+    MovieView view;
+    std::string_view* fields[] = { &view.title, &view.year, &view.imdb_id, &view.actors, &view.poster_url,
+        &view.plot, &view.rating, &view.director, &view.genre, &view.runtime, &view.type, &view.released };
+    for (uint32_t i = 0; i < kFieldCount; ++i) {
+        *fields[i] = std::string_view(m_blob + record.offsets[i], record.lengths[i]);
+    }
+    view.hasDetails = (record.flags & kHasDetails) != 0;
+    return view;
+}
+
+bool FavoritesSnapshot::write(const std::string& path, const std::vector<Movie>& movies) {
+    std::vector<SnapshotRecord> records(movies.size());
+    std::string blob;
+
+    for (size_t m = 0; m < movies.size(); ++m) {
+        const Movie& movie = movies[m];
+        const std::string* fields[] = { &movie.title, &movie.year, &movie.imdb_id, &movie.actors, &movie.poster_url,
+            &movie.plot, &movie.rating, &movie.director, &movie.genre, &movie.runtime, &movie.type, &movie.released };
+
+        SnapshotRecord& record = records[m];
+        for (uint32_t i = 0; i < kFieldCount; ++i) {
+            record.offsets[i] = static_cast<uint32_t>(blob.size());
+            record.lengths[i] = static_cast<uint32_t>(fields[i]->size());
+            blob += *fields[i];
+        }
+        record.flags = movie.hasDetails ? kHasDetails : 0;
+    }
+
+    SnapshotHeader header{};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.count = static_cast<uint32_t>(movies.size());
+    header.fieldCount = kFieldCount;
+    header.blobSize = blob.size();
+
+    std::string data;
+    data.reserve(sizeof(header) + records.size() * sizeof(SnapshotRecord) + blob.size());
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(SnapshotRecord));
+    data += blob;
+    return writeFileAtomic(path, data);
+}
+
+json FavoritesSnapshot::toJson(const Movie& movie) {
+    return json{
+        {"title", movie.title},
+        {"year", movie.year},
+        {"imdb_id", movie.imdb_id},
+        {"poster_url", movie.poster_url},
+        {"type", movie.type},
+        {"plot", movie.plot},
+        {"rating", movie.rating},
+        {"actors", movie.actors},
+        {"director", movie.director},
+        {"genre", movie.genre},
+        {"runtime", movie.runtime},
+        {"released", movie.released},
+        {"hasDetails", movie.hasDetails}
+    };
+}
+
+Movie FavoritesSnapshot::fromJson(const json& movieJson) {
+    Movie movie;
+    movie.title = movieJson["title"];
+    movie.year = movieJson["year"];
+    movie.imdb_id = movieJson["imdb_id"];
+    movie.poster_url = movieJson["poster_url"];
+    movie.type = movieJson["type"];
+    movie.plot = movieJson["plot"];
+    movie.rating = movieJson["rating"];
+    movie.actors = movieJson["actors"];
+    movie.director = movieJson["director"];
+    movie.genre = movieJson["genre"];
+    movie.runtime = movieJson["runtime"];
+    movie.released = movieJson["released"];
+    movie.hasDetails = movieJson["hasDetails"];
+    return movie;
+}
+
+bool FavoritesSnapshot::readJson(const std::string& path, std::vector<Movie>& movies) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    try {
+        json j = json::parse(file);
+        movies.clear();
+        movies.reserve(j.size());
+        for (const auto& movieJson : j) {
+            movies.push_back(fromJson(movieJson));
+        }
+        return true;
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool FavoritesSnapshot::writeJson(const std::string& path, const std::vector<Movie>& movies) {
+    json j = json::array();
+    for (const auto& movie : movies) {
+        j.push_back(toJson(movie));
+    }
+    return writeFileAtomic(path, j.dump(4));
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <json.hpp>
+#include "movie.h"
+#include "MappedFile.h"
+
+// Read-only view of one snapshot entry, field names match Movie.
+// The views point into the mapped file and live as long as the snapshot.
+struct MovieView {
+    std::string_view title;
+    std::string_view year;
+    std::string_view imdb_id;
+    std::string_view actors;
+    std::string_view poster_url;
+    std::string_view plot;
+    std::string_view rating;
+    std::string_view director;
+    std::string_view genre;
+    std::string_view runtime;
+    std::string_view type;
+    std::string_view released;
+    bool hasDetails;
+
+    Movie toMovie() const;
+};
+
+// Compact binary favorites file: a fixed header, one offset table entry
+// per movie and one string blob, native byte order. It is mapped, not
+// parsed, so opening costs the same for 10 or 100k favorites.
+class FavoritesSnapshot {
+public:
+    bool open(const std::string& path);     // false when missing or not a valid snapshot
+    void close();
+
+    size_t size() const { return m_count; }
+    MovieView at(size_t index) const;
+
+    static bool write(const std::string& path, const std::vector<Movie>& movies);
+
+    // The JSON schema of favorites.json, for import and export
+    static bool readJson(const std::string& path, std::vector<Movie>& movies);
+    static bool writeJson(const std::string& path, const std::vector<Movie>& movies);
+    static nlohmann::json toJson(const Movie& movie);
+    static Movie fromJson(const nlohmann::json& movieJson);
+
+private:
+    MappedFile m_file;
+    const char* m_records = nullptr;
+    const char* m_blob = nullptr;
+    size_t m_count = 0;
+};
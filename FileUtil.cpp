@@ -0,0 +1,39 @@
+#include "FileUtil.h"
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+bool syncFile(FILE* file) {
+    if (fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool writeFileAtomic(const std::string& path, const std::string& data) {
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = syncFile(file) && written;
+    fclose(file);
+
+    std::error_code ec;
+    if (written) {
+        fs::rename(tempPath, path, ec);
+    }
+    if (!written || ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdio>
+#include <string>
+
+// Durable file writes shared by the favorites files, the search index and the api quota
+
+// fflush and fsync (_commit on Windows)
+bool syncFile(FILE* file);
+
+// Writes through a temp file, fsync and rename, never leaves a half written file
+bool writeFileAtomic(const std::string& path, const std::string& data);
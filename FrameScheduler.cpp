@@ -0,0 +1,55 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+
+namespace {
+    const int kInputFrames = 2;     // frames after the one for the input, for releases and window resizes
+}
+
+FrameScheduler::FrameScheduler(double maxFps) {
+    setMaxFps(maxFps);
+}
+
+void FrameScheduler::setMaxFps(double fps) {
+    m_minInterval = fps > 0.0 ?
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps)) : Clock::duration::zero();
+}
+
+void FrameScheduler::requestFrame() {
+    // Only the first request after a frame wakes the loop, the rest coalesce
+    if (!m_requested.exchange(true) && m_wake) {
+        m_wake();
+    }
+}
+
+void FrameScheduler::requestFrameAt(Clock::time_point deadline) {
+    m_deadline = std::min(m_deadline, deadline);
+}
+
+void FrameScheduler::requestFrameAfter(double seconds) {
+    requestFrameAt(Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)));
+}
+
+void FrameScheduler::onInput() {
+    m_requested = true;
+    m_extraFrames = kInputFrames;
+}
+
+FrameScheduler::Clock::duration FrameScheduler::waitTime(Clock::time_point now) const {
+    Clock::time_point due = m_requested ? now : m_deadline;
+    if (due == Clock::time_point::max()) return Clock::duration::max();
+
+    if (m_frames > 0) due = std::max(due, m_lastFrame + m_minInterval);
+    return due > now ? due - now : Clock::duration::zero();
+}
+
+void FrameScheduler::beginFrame(Clock::time_point now) {
+    // Cleared before the frame reads any state, a change made while it draws asks again
+    m_requested = false;
+    if (m_extraFrames > 0) {
+        --m_extraFrames;
+        m_requested = true;
+    }
+    if (m_deadline <= now) m_deadline = Clock::time_point::max();
+    m_lastFrame = now;
+    ++m_frames;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// Decides when the next frame is drawn, so a static UI costs no CPU. The
+// loop sleeps until input arrives, a worker calls requestFrame(), or the
+// earliest deadline the UI asked for passes. maxFps caps the rate while
+// things keep changing.
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FrameScheduler(double maxFps = 60.0);
+
+    void setMaxFps(double fps);     // 0 = no cap
+    // How requestFrame interrupts the loop's wait, e.g. posting a window message.
+    // Set before any worker can call requestFrame
+    void setWakeHandler(std::function<void()> wake) { m_wake = std::move(wake); }
+
+    // Any thread: something the UI shows changed, draw as soon as the cap allows
+    void requestFrame();
+
+    // UI thread only
+    void requestFrameAt(Clock::time_point deadline);    // debounce, cursor blink
+    void requestFrameAfter(double seconds);
+    void onInput();                 // draws now and a few frames after, ImGui settles over frames
+    Clock::duration waitTime(Clock::time_point now) const;     // zero when a frame is due, max() when idle
+    void beginFrame(Clock::time_point now);     // requests made from here on get another frame
+
+    uint64_t framesDrawn() const { return m_frames; }
+
+private:
+    std::atomic<bool> m_requested{ true };      // the first frame
+    std::function<void()> m_wake;
+    Clock::time_point m_deadline = Clock::time_point::max();
+    Clock::time_point m_lastFrame;
+    Clock::duration m_minInterval{ 0 };
+    int m_extraFrames = 0;
+    uint64_t m_frames = 0;
+};
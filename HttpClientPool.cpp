@@ -0,0 +1,103 @@
+#include "HttpClientPool.h"
+#include <httplib.h>
+
+HttpClientPool::HttpClientPool(const std::string& host, int port, size_t maxConnections)
+    : m_host(host), m_port(port), m_maxConnections(maxConnections ? maxConnections : 1),
+    m_maxIdle(4) {
+}
+
+HttpClientPool::~HttpClientPool() = default;
+
+std::unique_ptr<httplib::Client> HttpClientPool::createClient() const {
+    auto client = std::make_unique<httplib::Client>(m_host, m_port);
+    client->set_keep_alive(true);
+    client->set_connection_timeout(5);
+    client->set_read_timeout(10);
+    return client;
+}
+
+HttpClientPool::Connection HttpClientPool::acquire() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return !m_idle.empty() || m_leased < m_maxConnections; });
+
+    Connection connection;
+    if (!m_idle.empty()) {
+        // Most recently used first, its socket is the most likely to be alive
+        connection = std::move(m_idle.back());
+        m_idle.pop_back();
+    }
+    ++m_leased;
+    lock.unlock();
+
+    if (!connection.client) {
+        connection.client = createClient();
+        ++m_created;
+    }
+    else if (connection.client->is_socket_open() &&
+        std::chrono::steady_clock::now() - connection.lastUsed < m_maxIdle) {
+        ++m_reused;
+    }
+    else {
+        // Closed or likely timed out on the server, start from a fresh socket
+        connection.client->stop();
+        ++m_reconnects;
+    }
+    return connection;
+}
+
+void HttpClientPool::release(Connection connection, bool healthy) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_leased;
+        if (healthy) {
+            connection.lastUsed = std::chrono::steady_clock::now();
+            m_idle.push_back(std::move(connection));
+        }
+    }
+    m_cv.notify_one();
+}
+
+HttpResponse HttpClientPool::get(const std::string& path) {
+    ++m_requests;
+    Connection connection = acquire();
+
+    HttpResponse response;
+    auto res = connection.client->Get(path);
+    if (res) {
+        response.status = res->status;
+        response.body = std::move(res->body);
+    }
+    else {
+        ++m_failures;
+    }
+
+    release(std::move(connection), static_cast<bool>(res));
+    return response;
+}
+
+int HttpClientPool::getInto(const std::string& path, std::string& body) {
+    ++m_requests;
+    Connection connection = acquire();
+
+    body.clear();
+    auto res = connection.client->Get(path, [&body](const char* data, size_t length) {
+        body.append(data, length);
+        return true;
+        });
+    if (!res) {
+        ++m_failures;
+    }
+
+    release(std::move(connection), static_cast<bool>(res));
+    return res ? res->status : 0;
+}
+
+HttpPoolStats HttpClientPool::stats() const {
+    HttpPoolStats s;
+    s.requests = m_requests;
+    s.reused = m_reused;
+    s.reconnects = m_reconnects;
+    s.created = m_created;
+    s.failures = m_failures;
+    return s;
+}
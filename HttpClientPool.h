@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace httplib { class Client; }
+
+struct HttpResponse {
+    int status = 0;         // 0 when the request did not complete
+    std::string body;
+
+    explicit operator bool() const { return status != 0; }
+};
+
+struct HttpPoolStats {
+    uint64_t requests = 0;
+    uint64_t reused = 0;        // served on an already open keep-alive socket
+    uint64_t reconnects = 0;    // pooled client whose socket had to be reopened
+    uint64_t created = 0;       // brand new clients
+    uint64_t failures = 0;
+};
+
+// Keeps up to maxConnections keep-alive clients to one host and leases them
+// to one thread at a time. Idle clients are health checked before reuse.
+class HttpClientPool {
+public:
+    HttpClientPool(const std::string& host, int port = 80, size_t maxConnections = 8);
+    ~HttpClientPool();
+
+    HttpClientPool(const HttpClientPool&) = delete;
+    HttpClientPool& operator=(const HttpClientPool&) = delete;
+
+    HttpResponse get(const std::string& path);
+    // Streams the body into body (cleared first, its capacity is reused).
+    // Returns the status, 0 when the request did not complete
+    int getInto(const std::string& path, std::string& body);
+
+    HttpPoolStats stats() const;
+    const std::string& host() const { return m_host; }
+    int port() const { return m_port; }
+
+private:
+    struct Connection {
+        std::unique_ptr<httplib::Client> client;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    Connection acquire();
+    void release(Connection connection, bool healthy);
+    std::unique_ptr<httplib::Client> createClient() const;
+
+    std::string m_host;
+    int m_port;
+    size_t m_maxConnections;
+    std::chrono::seconds m_maxIdle;     // server side keep-alive is short, drop older sockets
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<Connection> m_idle;
+    size_t m_leased = 0;
+
+    std::atomic<uint64_t> m_requests{ 0 };
+    std::atomic<uint64_t> m_reused{ 0 };
+    std::atomic<uint64_t> m_reconnects{ 0 };
+    std::atomic<uint64_t> m_created{ 0 };
+    std::atomic<uint64_t> m_failures{ 0 };
+};
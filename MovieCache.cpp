@@ -0,0 +1,101 @@
+#include "MovieCache.h"
+#include <functional>
+
+MovieCache& MovieCache::instance() {
+    static MovieCache cache;
+    return cache;
+}
+
+MovieCache::MovieCache(size_t maxBytes, size_t shardCount) {
+    if (shardCount == 0) shardCount = 1;
+    m_maxBytesPerShard = maxBytes / shardCount;
+
+    for (size_t i = 0; i < shardCount; ++i) {
+        m_shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+MovieCache::Shard& MovieCache::shardFor(const std::string& imdbId) const {
+    return *m_shards[std::hash<std::string>()(imdbId) % m_shards.size()];
+}
+
+size_t MovieCache::estimateBytes(const Movie& movie) {
+    auto heap = [](const std::string& s) {
+        return s.capacity() > sizeof(std::string) ? s.capacity() : 0;   // short strings live inline
+    };
+
+    size_t bytes = sizeof(Movie) + 64;  // list node and index entry overhead
+    bytes += heap(movie.title) + heap(movie.year) + heap(movie.imdb_id) + heap(movie.actors);
+    bytes += heap(movie.poster_url) + heap(movie.plot) + heap(movie.rating) + heap(movie.director);
+    bytes += heap(movie.genre) + heap(movie.runtime) + heap(movie.type) + heap(movie.released);
+    bytes += sizeof(std::string) + heap(movie.imdb_id);    // the index key
+    return bytes;
+}
+
+bool MovieCache::get(const std::string& imdbId, Movie& out) {
+    Shard& shard = shardFor(imdbId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(imdbId);
+    if (it == shard.index.end()) {
+        ++m_misses;
+        return false;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    out = *it->second;
+    ++m_hits;
+    return true;
+}
+
+void MovieCache::put(const Movie& movie) {
+    if (!movie.hasDetails || movie.imdb_id.empty()) return;
+
+    Movie entry = movie;
+    entry.fetching = false;
+    size_t bytes = estimateBytes(entry);
+
+    Shard& shard = shardFor(entry.imdb_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(entry.imdb_id);
+    if (it != shard.index.end()) {
+        shard.bytes -= estimateBytes(*it->second);
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+
+    shard.lru.push_front(std::move(entry));
+    shard.index[shard.lru.front().imdb_id] = shard.lru.begin();
+    shard.bytes += bytes;
+
+    while (shard.bytes > m_maxBytesPerShard && shard.lru.size() > 1) {
+        const Movie& victim = shard.lru.back();
+        shard.bytes -= estimateBytes(victim);
+        shard.index.erase(victim.imdb_id);
+        shard.lru.pop_back();
+        ++m_evictions;
+    }
+}
+
+void MovieCache::clear() {
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->lru.clear();
+        shard->bytes = 0;
+    }
+}
+
+MovieCacheStats MovieCache::stats() const {
+    MovieCacheStats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.evictions = m_evictions;
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        s.entries += shard->lru.size();
+        s.bytes += shard->bytes;
+    }
+    return s;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "movie.h"
+
+struct MovieCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Process wide LRU of fully detailed movies keyed by imdb_id.
+// Lock striped: every shard has its own mutex, list and byte budget.
+class MovieCache {
+public:
+    static MovieCache& instance();
+
+    explicit MovieCache(size_t maxBytes = 32 * 1024 * 1024, size_t shardCount = 16);
+
+    bool get(const std::string& imdbId, Movie& out);
+    void put(const Movie& movie);       // ignored unless movie.hasDetails
+    void clear();
+
+    MovieCacheStats stats() const;
+
+    static size_t estimateBytes(const Movie& movie);
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::list<Movie> lru;           // most recently used at the front
+        std::unordered_map<std::string, std::list<Movie>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    Shard& shardFor(const std::string& imdbId) const;
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    size_t m_maxBytesPerShard;
+
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+    std::atomic<uint64_t> m_evictions{ 0 };
+};
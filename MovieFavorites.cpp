@@ -1,23 +1,56 @@
 #include "MovieFavorites.h"
+#include "MovieCache.h"
 
-MovieFavorites::MovieFavorites(const std::string& filename)
-    : favoritesFile(filename) {
+namespace {
+    // The log is folded into the snapshot once it has more records than this
+    // and more than there are favorites, so replay stays cheap
+    const size_t kCompactMinRecords = 256;
+    const std::chrono::seconds kRetryDelay(1);     // after a failed write, e.g. disk full
+}
+
+MovieFavorites::MovieFavorites(const std::string& filename, bool binarySnapshot)
+    : favoritesFile(filename), favoriteIndex(std::make_shared<const FavoriteIndex>()),
+    journal(filename + ".log"), useBinarySnapshot(binarySnapshot) {
+    // favorites.json -> favorites.bin
+    size_t dot = filename.rfind('.');
+    binaryFile = (dot == std::string::npos ? filename : filename.substr(0, dot)) + ".bin";
+
+    writerThread = std::thread([this]() { writerLoop(); });
 }
 
 MovieFavorites::~MovieFavorites() {
-    while (saving) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (loaderThread.joinable()) {
+        loaderThread.join();    // the callback may still be running
+    }
+    {
+        std::lock_guard<std::mutex> lock(favoritesMutex);
+        stopWriter = true;
     }
+    writerCv.notify_one();
+    writerThread.join();    // the writer flushes whatever is still pending before it exits
+}
+
+void MovieFavorites::setFlushWindow(std::chrono::milliseconds window) {
+    std::lock_guard<std::mutex> lock(favoritesMutex);
+    flushWindow = window;
 }
 
 void MovieFavorites::addFavorite(const Movie& movie) {
+    Movie stored = movie;
+    if (!MovieCache::instance().get(movie.imdb_id, stored)) {   // save the full details when we have them
+        MovieCache::instance().put(movie);
+    }
+    stored.fetching = false;
+
     {
         std::lock_guard<std::mutex> lock(favoritesMutex);
-        if (!isFavorite(movie.imdb_id)) {
-            favorites.push_back(movie);
+        if (!isFavorite(stored.imdb_id)) {
+            favorites.push_back(stored);
+            publishIndex();
+            pendingRecords.push_back(json{ {"op", "add"}, {"movie", FavoritesSnapshot::toJson(stored)} }.dump());
+            scheduleFlush();
         }
     }
-    saveFavoritesAsync();
 }
 
 void MovieFavorites::removeFavorite(const std::string& imdb_id) {
@@ -28,44 +61,98 @@ void MovieFavorites::removeFavorite(const std::string& imdb_id) {
 
         if (it != favorites.end()) {
             favorites.erase(it);
+            publishIndex();
+            pendingRecords.push_back(json{ {"op", "remove"}, {"imdb_id", imdb_id} }.dump());
+            scheduleFlush();
         }
     }
-    saveFavoritesAsync();
 }
 
 bool MovieFavorites::isFavorite(const std::string& imdb_id) const {
-    return std::find_if(favorites.begin(), favorites.end(),
-        [&imdb_id](const Movie& m) { return m.imdb_id == imdb_id; }) != favorites.end();
+    // The render loop calls this for every open row, it never waits for a writer
+    std::shared_ptr<const FavoriteIndex> index = std::atomic_load(&favoriteIndex);
+    return index->contains(imdb_id);
 }
 
-void MovieFavorites::loadFavoritesFromFile() {
-    std::ifstream file(favoritesFile);
-    if (file.is_open()) {
-        try {
-            json j = json::parse(file);
-            std::lock_guard<std::mutex> lock(favoritesMutex);
-            favorites.clear();
-
-            for (const auto& movieJson : j) {
-                Movie movie;
-                movie.title = movieJson["title"];
-                movie.year = movieJson["year"];
-                movie.imdb_id = movieJson["imdb_id"];
-                movie.poster_url = movieJson["poster_url"];
-                movie.type = movieJson["type"];
-                movie.plot = movieJson["plot"];
-                movie.rating = movieJson["rating"];
-                movie.actors = movieJson["actors"];
-                movie.director = movieJson["director"];
-                movie.genre = movieJson["genre"];
-                movie.runtime = movieJson["runtime"];
-                movie.released = movieJson["released"];
-                movie.hasDetails = movieJson["hasDetails"];
+void MovieFavorites::publishIndex() {
+    std::vector<std::string> ids;
+    ids.reserve(favorites.size());
+    for (const auto& movie : favorites) {
+        ids.push_back(movie.imdb_id);
+    }
+    // Readers still holding the old index keep it alive until they are done
+    std::atomic_store(&favoriteIndex, std::shared_ptr<const FavoriteIndex>(std::make_shared<FavoriteIndex>(ids)));
+}
+
+void MovieFavorites::applyRecord(const std::string& record) {
+    // Called with favoritesMutex held. Records are idempotent, replaying a
+    // log that already went into the snapshot gives the same favorites
+    try {
+        json j = json::parse(record);
+        if (j["op"] == "add") {
+            Movie movie = FavoritesSnapshot::fromJson(j["movie"]);
+            auto it = std::find_if(favorites.begin(), favorites.end(),
+                [&movie](const Movie& m) { return m.imdb_id == movie.imdb_id; });
+            if (it == favorites.end()) {
                 favorites.push_back(movie);
             }
         }
-        catch (const std::exception&) {
-            // Handle error if needed
+        else if (j["op"] == "remove") {
+            std::string imdbId = j["imdb_id"];
+            favorites.erase(std::remove_if(favorites.begin(), favorites.end(),
+                [&imdbId](const Movie& m) { return m.imdb_id == imdbId; }), favorites.end());
+        }
+    }
+    catch (const std::exception&) {
+        // a damaged record, skip it
+    }
+}
+
+void MovieFavorites::loadFavoritesFromFile() {
+    std::lock_guard<std::mutex> journalLock(journalMutex);
+    writeJournal();     // changes made before the load must be on disk before we read it
+
+    std::vector<Movie> loaded;
+    bool importJson = true;
+    if (useBinarySnapshot) {
+        // Mapped, no parsing: one Movie per entry straight from the views
+        FavoritesSnapshot snapshot;
+        if (snapshot.open(binaryFile)) {
+            loaded.reserve(snapshot.size());
+            for (size_t i = 0; i < snapshot.size(); ++i) {
+                loaded.push_back(snapshot.at(i).toMovie());
+            }
+            importJson = false;
+        }   // the mapping is closed here, the next compaction may replace the file
+    }
+    if (importJson) {
+        FavoritesSnapshot::readJson(favoritesFile, loaded);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(favoritesMutex);
+        favorites = std::move(loaded);
+        journalRecords = journal.replay([this](const std::string& record) { applyRecord(record); });
+        // Changes made after the flush above are not in the file yet
+        for (const auto& record : pendingRecords) {
+            applyRecord(record);
+        }
+        loadedFromDisk = true;
+
+        for (auto& movie : favorites) {
+            if (movie.hasDetails) {
+                MovieCache::instance().put(movie);
+            }
+            else {
+                MovieCache::instance().get(movie.imdb_id, movie);
+            }
+        }
+        publishIndex();
+
+        if (journalRecords > std::max(kCompactMinRecords, favorites.size()) ||
+            (useBinarySnapshot && importJson && !favorites.empty())) {
+            compactRequested = true;    // also converts an imported favorites.json to binary
+            scheduleFlush();
         }
     }
 }
@@ -73,8 +160,12 @@ void MovieFavorites::loadFavoritesFromFile() {
 void MovieFavorites::loadFavoritesAsync(std::function<void(const std::vector<Movie>&)> callback) {
     if (loading) return;
 
+    if (loaderThread.joinable()) {
+        loaderThread.join();    // finished, loading is only cleared at its end
+    }
+
     loading = true;
-    std::thread([this, callback]() {
+    loaderThread = std::thread([this, callback]() {
         loadFavoritesFromFile();
 
         std::vector<Movie> moviesCopy;
@@ -88,47 +179,93 @@ void MovieFavorites::loadFavoritesAsync(std::function<void(const std::vector<Mov
         }
 
         loading = false;
-        }).detach();
+        });
 }
 
-void MovieFavorites::saveFavoritesToFile() {
-    json j = json::array();
+bool MovieFavorites::writeJournal() {
+    // Called with journalMutex held, it is the only code that touches the files
+    std::vector<std::string> batch;
+    std::vector<Movie> snapshot;
+    bool compact = false;
     {
         std::lock_guard<std::mutex> lock(favoritesMutex);
-        for (const auto& movie : favorites) {
-            json movieJson = {
-                {"title", movie.title},
-                {"year", movie.year},
-                {"imdb_id", movie.imdb_id},
-                {"poster_url", movie.poster_url},
-                {"type", movie.type},
-                {"plot", movie.plot},
-                {"rating", movie.rating},
-                {"actors", movie.actors},
-                {"director", movie.director},
-                {"genre", movie.genre},
-                {"runtime", movie.runtime},
-                {"released", movie.released},
-                {"hasDetails", movie.hasDetails}
-            };
-            j.push_back(movieJson);
+        batch.swap(pendingRecords);
+        journalRecords += batch.size();
+
+        // Only a loaded list may replace the snapshot, otherwise it would lose the favorites on disk
+        bool due = compactRequested || journalRecords > std::max(kCompactMinRecords, favorites.size());
+        if (due && loadedFromDisk) {
+            compact = true;
+            snapshot = favorites;   // already includes every record in batch
+            journalRecords = 0;
+            compactRequested = false;
         }
     }
 
-    std::ofstream file(favoritesFile);
-    if (file.is_open()) {
-        file << j.dump(4);
+    if (compact) {
+        bool written = useBinarySnapshot ?
+            FavoritesSnapshot::write(binaryFile, snapshot) :
+            FavoritesSnapshot::writeJson(favoritesFile, snapshot);
+        if (written && useBinarySnapshot) {
+            FavoritesSnapshot::writeJson(favoritesFile, snapshot);  // the file users see and back up stays current
+        }
+        if (written) {
+            journal.reset();
+            return true;
+        }
+        // the old snapshot is still in place, keep the records in the log
     }
-}
+    if (journal.append(batch)) return true;
 
-void MovieFavorites::saveFavoritesAsync() {
-    if (saving) return;
+    // Not on disk: back in front of the newer changes, the writer retries
+    std::lock_guard<std::mutex> lock(favoritesMutex);
+    journalRecords -= std::min(journalRecords, batch.size());
+    pendingRecords.insert(pendingRecords.begin(), std::make_move_iterator(batch.begin()),
+        std::make_move_iterator(batch.end()));
+    return false;
+}
 
+void MovieFavorites::scheduleFlush() {
+    // Called with favoritesMutex held. Only marks the state dirty,
+    // the writer thread picks it up
+    dirty = true;
     saving = true;
-    std::thread([this]() {
-        saveFavoritesToFile();
-        saving = false;
-        }).detach();
+    writerCv.notify_one();
+}
+
+void MovieFavorites::writerLoop() {
+    std::unique_lock<std::mutex> lock(favoritesMutex);
+    while (true) {
+        writerCv.wait(lock, [this]() { return dirty || stopWriter; });
+
+        // Let a burst of changes pile up, they all go out in one write
+        writerCv.wait_for(lock, flushWindow, [this]() { return stopWriter; });
+        dirty = false;
+        lock.unlock();
+
+        bool written;
+        {
+            std::lock_guard<std::mutex> journalLock(journalMutex);
+            written = writeJournal();
+        }
+
+        lock.lock();
+        if (!written && !stopWriter) {
+            dirty = true;   // saving stays set, try again after a pause
+            writerCv.wait_for(lock, kRetryDelay, [this]() { return stopWriter; });
+            continue;
+        }
+        if (!dirty) {
+            saving = false;     // under the lock, a new change sets it again
+            if (stopWriter) return;
+        }
+    }
+}
+
+void MovieFavorites::saveFavoritesAsync() {
+    std::lock_guard<std::mutex> lock(favoritesMutex);
+    compactRequested = true;    // full snapshot, the log starts over
+    scheduleFlush();
 }
 
 void MovieFavorites::toggleFavorite(const Movie& movie) {
@@ -140,6 +277,15 @@ void MovieFavorites::toggleFavorite(const Movie& movie) {
     }
 }
 
+bool MovieFavorites::exportJson(const std::string& path) const {
+    std::vector<Movie> copy;
+    {
+        std::lock_guard<std::mutex> lock(favoritesMutex);
+        copy = favorites;
+    }
+    return FavoritesSnapshot::writeJson(path, copy);
+}
+
 size_t MovieFavorites::getFavoritesCount() const {
     std::lock_guard<std::mutex> lock(favoritesMutex);
     return favorites.size();
@@ -6,32 +6,75 @@
 #include <thread>
 #include <future>
 #include <mutex>
-#include "Movie.h"
+#include <memory>
+#include <chrono>
+#include <condition_variable>
+#include "movie.h"
+#include "FavoriteIndex.h"
+#include "FavoritesJournal.h"
+#include "FavoritesSnapshot.h"
 
 using json = nlohmann::json;
 
 class MovieFavorites {
 public:
-    MovieFavorites(const std::string& filename = "favorites.json");
+    // binarySnapshot (opt-in) keeps the snapshot in the mapped binary format
+    // (favorites.bin), an existing favorites.json is imported on the first load
+    // and rewritten from the snapshot on every compaction
+    MovieFavorites(const std::string& filename = "favorites.json", bool binarySnapshot = false);
     ~MovieFavorites();
 
     void addFavorite(const Movie& movie);
     void removeFavorite(const std::string& imdb_id);
-    bool isFavorite(const std::string& imdb_id) const;
+    bool isFavorite(const std::string& imdb_id) const;     // lock free, safe from any thread
+    // On a thread the object owns, the destructor waits for it. Ignored while a load runs
     void loadFavoritesAsync(std::function<void(const std::vector<Movie>&)> callback);
-    void saveFavoritesAsync();
+    void saveFavoritesAsync();      // full snapshot, changes are journaled on their own
     void toggleFavorite(const Movie& movie);
+    bool exportJson(const std::string& path) const;    // the favorites.json schema
     size_t getFavoritesCount() const;
     bool isLoading() const { return loading; }
-    bool isSaving() const { return saving; }
+    bool isSaving() const { return saving; }   // changes not on disk yet
+
+    // Changes within the window after the first one are written together
+    void setFlushWindow(std::chrono::milliseconds window);
 
 private:
     std::string favoritesFile;
     std::vector<Movie> favorites;
     mutable std::mutex favoritesMutex;
+    // Read side of the favorites: an immutable index swapped in whole after
+    // every change (RCU style), readers only take an atomic shared_ptr copy
+    std::shared_ptr<const FavoriteIndex> favoriteIndex;
     std::atomic<bool> loading{ false };
     std::atomic<bool> saving{ false };
 
+    // Persistence: every change is queued as a journal record (under
+    // favoritesMutex, so the log order is the change order) and appended
+    // in batches, the snapshot favoritesFile is rewritten on compaction
+    std::mutex journalMutex;                    // serializes all file I/O
+    FavoritesJournal journal;
+    std::vector<std::string> pendingRecords;
+    size_t journalRecords = 0;                  // records in the log since the last snapshot
+    bool compactRequested = false;
+    bool loadedFromDisk = false;
+    bool useBinarySnapshot;
+    std::string binaryFile;
+
+    void publishIndex();    // call with favoritesMutex held
+    void applyRecord(const std::string& record);
     void loadFavoritesFromFile();
-    void saveFavoritesToFile();
+    bool writeJournal();    // false when the batch could not be written, it is pending again
+
+    // One long-lived writer thread does all the saving. scheduleFlush
+    // (favoritesMutex held) marks the state dirty and wakes it up
+    std::chrono::milliseconds flushWindow{ 200 };
+    std::condition_variable writerCv;
+    bool dirty = false;
+    bool stopWriter = false;
+    std::thread writerThread;   // started last in the constructor
+    std::thread loaderThread;   // the last loadFavoritesAsync, joined before the next one
+
+    void scheduleFlush();
+    void writerLoop();
 };
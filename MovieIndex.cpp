@@ -0,0 +1,378 @@
+#include "MovieIndex.h"
+#include "MappedFile.h"
+#include "FileUtil.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+const char kMagic[4] = { 'O', 'M', 'I', '1' };
+
+void putVarint(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool getVarint(const char*& p, const char* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 35; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void putString(std::string& out, const std::string& text) {
+    putVarint(out, static_cast<uint32_t>(text.size()));
+    out += text;
+}
+
+bool getString(const char*& p, const char* end, std::string& text) {
+    uint32_t length;
+    if (!getVarint(p, end, length) || static_cast<size_t>(end - p) < length) return false;
+    text.assign(p, length);
+    p += length;
+    return true;
+}
+
+// Fields of Movie in file order
+std::string Movie::* const kFields[] = { &Movie::title, &Movie::year, &Movie::imdb_id, &Movie::actors,
+    &Movie::poster_url, &Movie::plot, &Movie::rating, &Movie::director, &Movie::genre, &Movie::runtime,
+    &Movie::type, &Movie::released };
+
+// Smallest doc record: an empty string per field and the details flag
+const size_t kMinDocBytes = sizeof(kFields) / sizeof(kFields[0]) + 1;
+
+// A posting list from the file: ascending ids below docCount that agree with count and last
+bool validPosting(const std::string& bytes, uint32_t count, uint32_t last, uint32_t docCount) {
+    const char* p = bytes.data();
+    const char* end = p + bytes.size();
+    uint64_t doc = 0;
+    uint32_t decoded = 0;
+    uint32_t delta;
+    while (p < end) {
+        if (!getVarint(p, end, delta) || (decoded > 0 && delta == 0)) return false;
+        doc += delta;
+        if (doc >= docCount) return false;
+        ++decoded;
+    }
+    return decoded == count && (count == 0 ? last == 0 : doc == last);
+}
+
+// Sorted ids in both, in place
+void intersect(std::vector<uint32_t>& into, const std::vector<uint32_t>& other) {
+    std::vector<uint32_t> result;
+    std::set_intersection(into.begin(), into.end(), other.begin(), other.end(), std::back_inserter(result));
+    into.swap(result);
+}
+
+}
+
+MovieIndex::MovieIndex(const std::string& path) : m_path(path) {}
+
+std::vector<std::string> MovieIndex::tokenize(const std::string& text) {
+    // Letters and digits, lowercased. Bytes >= 0x80 (UTF-8) count as letters
+    std::vector<std::string> tokens;
+    std::string token;
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (std::isalnum(u) || u >= 0x80) {
+            token += static_cast<char>(std::tolower(u));
+        }
+        else if (!token.empty()) {
+            tokens.push_back(std::move(token));
+            token.clear();
+        }
+    }
+    if (!token.empty()) tokens.push_back(std::move(token));
+    return tokens;
+}
+
+std::set<std::string> MovieIndex::termsOf(const Movie& movie) {
+    std::set<std::string> terms;
+    for (const std::string* field : { &movie.title, &movie.actors, &movie.director, &movie.genre, &movie.plot }) {
+        if (*field == "N/A") continue;
+        for (auto& token : tokenize(*field)) {
+            terms.insert(std::move(token));
+        }
+    }
+    return terms;
+}
+
+std::vector<uint32_t> MovieIndex::decode(const Posting& posting) {
+    std::vector<uint32_t> docs;
+    docs.reserve(posting.count);
+    const char* p = posting.bytes.data();
+    const char* end = p + posting.bytes.size();
+    uint32_t doc = 0;
+    uint32_t delta;
+    while (p < end && getVarint(p, end, delta)) {
+        doc += delta;
+        docs.push_back(doc);
+    }
+    return docs;
+}
+
+void MovieIndex::encode(const std::vector<uint32_t>& docs, Posting& posting) {
+    posting.bytes.clear();
+    uint32_t previous = 0;
+    for (uint32_t doc : docs) {
+        putVarint(posting.bytes, doc - previous);
+        previous = doc;
+    }
+    posting.count = static_cast<uint32_t>(docs.size());
+    posting.last = docs.empty() ? 0 : docs.back();
+}
+
+void MovieIndex::addPosting(const std::string& term, uint32_t doc) {
+    Posting& posting = m_terms[term];
+    if (posting.count == 0 || doc > posting.last) {
+        putVarint(posting.bytes, doc - (posting.count ? posting.last : 0));  // the common case, newest doc
+        posting.last = doc;
+        ++posting.count;
+        return;
+    }
+
+    // Details of an older movie, insert in the middle
+    std::vector<uint32_t> docs = decode(posting);
+    auto it = std::lower_bound(docs.begin(), docs.end(), doc);
+    if (it != docs.end() && *it == doc) return;
+    docs.insert(it, doc);
+    encode(docs, posting);
+}
+
+void MovieIndex::removePosting(const std::string& term, uint32_t doc) {
+    auto found = m_terms.find(term);
+    if (found == m_terms.end()) return;
+
+    std::vector<uint32_t> docs = decode(found->second);
+    docs.erase(std::remove(docs.begin(), docs.end(), doc), docs.end());
+    if (docs.empty()) {
+        m_terms.erase(found);
+    }
+    else {
+        encode(docs, found->second);
+    }
+}
+
+void MovieIndex::add(const Movie& movie) {
+    if (movie.imdb_id.empty()) return;
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto found = m_docIds.find(movie.imdb_id);
+    if (found == m_docIds.end()) {
+        uint32_t doc = static_cast<uint32_t>(m_docs.size());
+        m_docIds.emplace(movie.imdb_id, doc);
+        m_docs.push_back(movie);
+        m_docs.back().fetching = false;
+        for (const auto& term : termsOf(movie)) {
+            addPosting(term, doc);
+        }
+        ++m_version;
+        return;
+    }
+
+    // Known movie: only details can add something, a search hit never removes them
+    uint32_t doc = found->second;
+    Movie& stored = m_docs[doc];
+    if (!movie.hasDetails || stored.hasDetails) return;
+
+    std::set<std::string> before = termsOf(stored);
+    stored = movie;
+    stored.fetching = false;
+    std::set<std::string> after = termsOf(stored);
+
+    for (const auto& term : after) {
+        if (!before.count(term)) addPosting(term, doc);
+    }
+    for (const auto& term : before) {
+        if (!after.count(term)) removePosting(term, doc);
+    }
+    ++m_version;
+}
+
+std::vector<uint32_t> MovieIndex::match(const std::string& word, bool prefix) const {
+    if (!prefix) {
+        auto found = m_terms.find(word);
+        return found == m_terms.end() ? std::vector<uint32_t>() : decode(found->second);
+    }
+
+    // Every dictionary word starting with the prefix, gathered and sorted once
+    std::vector<uint32_t> docs;
+    size_t lists = 0;
+    for (auto it = m_terms.lower_bound(word);
+        it != m_terms.end() && it->first.compare(0, word.size(), word) == 0; ++it, ++lists) {
+        std::vector<uint32_t> more = decode(it->second);
+        docs.insert(docs.end(), more.begin(), more.end());
+    }
+    if (lists > 1) {
+        std::sort(docs.begin(), docs.end());
+        docs.erase(std::unique(docs.begin(), docs.end()), docs.end());
+    }
+    return docs;
+}
+
+std::vector<Movie> MovieIndex::search(const std::string& query, size_t limit) const {
+    std::vector<std::string> words = tokenize(query);
+    if (words.empty()) return {};
+
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+    // The last word may still be typed, it matches as a prefix. Rarest word
+    // first keeps the intersections small
+    std::vector<std::vector<uint32_t>> lists;
+    for (size_t i = 0; i < words.size(); ++i) {
+        lists.push_back(match(words[i], i + 1 == words.size()));
+        if (lists.back().empty()) return {};
+    }
+    std::sort(lists.begin(), lists.end(),
+        [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) { return a.size() < b.size(); });
+
+    std::vector<uint32_t> docs = lists.front();
+    for (size_t i = 1; i < lists.size() && !docs.empty(); ++i) {
+        intersect(docs, lists[i]);
+    }
+
+    // Title hits first, stable so the rest keeps the order the movies were seen in
+    auto titleScore = [this, &words](uint32_t doc) {
+        std::vector<std::string> titleWords = tokenize(m_docs[doc].title);
+        int score = 0;
+        for (size_t i = 0; i < words.size(); ++i) {
+            const std::string& word = words[i];
+            bool prefix = i + 1 == words.size();
+            for (const auto& titleWord : titleWords) {
+                if (prefix ? titleWord.compare(0, word.size(), word) == 0 : titleWord == word) {
+                    ++score;
+                    break;
+                }
+            }
+        }
+        return score;
+    };
+    std::vector<std::pair<int, uint32_t>> ranked;
+    ranked.reserve(docs.size());
+    for (uint32_t doc : docs) {
+        ranked.emplace_back(-titleScore(doc), doc);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<Movie> results;
+    for (size_t i = 0; i < ranked.size() && results.size() < limit; ++i) {
+        results.push_back(m_docs[ranked[i].second]);
+    }
+    return results;
+}
+
+bool MovieIndex::load() {
+    MappedFile file(m_path);
+    if (!file.isOpen() || file.size() < sizeof(kMagic) || memcmp(file.data(), kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+
+    const char* p = file.data() + sizeof(kMagic);
+    const char* end = file.data() + file.size();
+
+    std::vector<Movie> docs;
+    std::unordered_map<std::string, uint32_t> docIds;
+    std::map<std::string, Posting> terms;
+
+    uint32_t docCount;
+    if (!getVarint(p, end, docCount) || docCount > static_cast<size_t>(end - p) / kMinDocBytes) return false;
+    docs.resize(docCount);
+    for (uint32_t doc = 0; doc < docCount; ++doc) {
+        for (auto field : kFields) {
+            if (!getString(p, end, docs[doc].*field)) return false;
+        }
+        if (p >= end) return false;
+        docs[doc].hasDetails = *p++ != 0;
+        docIds.emplace(docs[doc].imdb_id, doc);
+    }
+
+    uint32_t termCount;
+    if (!getVarint(p, end, termCount)) return false;
+    for (uint32_t i = 0; i < termCount; ++i) {
+        std::string term;
+        Posting posting;
+        if (!getString(p, end, term) || !getVarint(p, end, posting.count) ||
+            !getVarint(p, end, posting.last) || !getString(p, end, posting.bytes) ||
+            !validPosting(posting.bytes, posting.count, posting.last, docCount)) {
+            return false;
+        }
+        terms.emplace_hint(terms.end(), std::move(term), std::move(posting));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_docs = std::move(docs);
+    m_docIds = std::move(docIds);
+    m_terms = std::move(terms);
+    m_savedVersion = ++m_version;
+    return true;
+}
+
+bool MovieIndex::save() {
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
+    std::string data;
+    uint64_t version;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (m_version == m_savedVersion) return true;
+        version = m_version;
+
+        data.append(kMagic, sizeof(kMagic));
+        putVarint(data, static_cast<uint32_t>(m_docs.size()));
+        for (const auto& movie : m_docs) {
+            for (auto field : kFields) {
+                putString(data, movie.*field);
+            }
+            data.push_back(movie.hasDetails ? 1 : 0);
+        }
+        putVarint(data, static_cast<uint32_t>(m_terms.size()));
+        for (const auto& term : m_terms) {
+            putString(data, term.first);
+            putVarint(data, term.second.count);
+            putVarint(data, term.second.last);
+            putString(data, term.second.bytes);
+        }
+    }
+
+    m_lastSave = std::chrono::steady_clock::now();
+    if (!writeFileAtomic(m_path, data)) return false;
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_savedVersion = version;   // changes made during the write keep the index dirty
+    return true;
+}
+
+bool MovieIndex::saveIfDue(std::chrono::seconds interval) {
+    {
+        std::lock_guard<std::mutex> saveLock(m_saveMutex);
+        if (std::chrono::steady_clock::now() - m_lastSave < interval) return true;
+    }
+    return save();
+}
+
+size_t MovieIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_docs.size();
+}
+
+size_t MovieIndex::termCount() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_terms.size();
+}
+
+size_t MovieIndex::postingBytes() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    size_t bytes = 0;
+    for (const auto& term : m_terms) {
+        bytes += term.second.bytes.size();
+    }
+    return bytes;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "movie.h"
+
+// Local full-text index over every movie the app has seen. Title, actors,
+// director, genre and plot are tokenized into lowercase words, every word
+// keeps a posting list of doc ids as varint deltas. The dictionary is
+// sorted, so a prefix is one range of it.
+// Thread safe: many readers, one writer.
+class MovieIndex {
+public:
+    explicit MovieIndex(const std::string& path = "movie_index.bin");
+
+    // New movie, or newer fields (details) of a known one
+    void add(const Movie& movie);
+
+    // Movies matching every query word, the last one as a prefix (it may
+    // still be typed). Title matches first, then in the order they were seen
+    std::vector<Movie> search(const std::string& query, size_t limit = 100) const;
+
+    bool load();    // replaces the contents with the file at path
+    bool save();    // no-op when nothing changed since the last load or save
+    // save() at most once per interval, searches call it when they finish.
+    // The last changes are written by the next due call or by save() at shutdown
+    bool saveIfDue(std::chrono::seconds interval);
+
+    size_t size() const;
+    size_t termCount() const;
+    size_t postingBytes() const;
+
+    static std::vector<std::string> tokenize(const std::string& text);
+
+private:
+    struct Posting {
+        std::string bytes;      // varint deltas of ascending doc ids
+        uint32_t last = 0;      // largest doc id, appends need no decode
+        uint32_t count = 0;
+    };
+
+    static std::set<std::string> termsOf(const Movie& movie);
+    static std::vector<uint32_t> decode(const Posting& posting);
+    static void encode(const std::vector<uint32_t>& docs, Posting& posting);
+
+    void addPosting(const std::string& term, uint32_t doc);
+    void removePosting(const std::string& term, uint32_t doc);
+    std::vector<uint32_t> match(const std::string& word, bool prefix) const;
+
+    std::string m_path;
+    std::mutex m_saveMutex;     // one writer of the file at a time
+    std::chrono::steady_clock::time_point m_lastSave;  // under m_saveMutex
+    mutable std::shared_mutex m_mutex;
+    std::vector<Movie> m_docs;
+    std::unordered_map<std::string, uint32_t> m_docIds;    // imdb_id -> doc
+    std::map<std::string, Posting> m_terms;
+    uint64_t m_version = 0;         // bumped on every change
+    uint64_t m_savedVersion = 0;    // version that is on disk
+};
@@ -1,13 +1,51 @@
 #include "MovieSearchService.h"
-#include <httplib.h>
-#include <json.hpp>
+#include "MovieCache.h"
 #include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <filesystem>
 
-using json = nlohmann::json;
+namespace {
+    const std::chrono::seconds kSearchTtl = std::chrono::hours(6);
+    const std::chrono::seconds kDetailsTtl = std::chrono::hours(24 * 7);    // details rarely change
+    const std::chrono::seconds kIndexSaveInterval(60);     // full rewrites of the index, the destructor saves the rest
+    const uint32_t kPageQuotaShare = 4;     // later pages of one search spend at most 1/4 of what is left today
+}
+
+MovieSearchService::MovieSearchService(const std::string& host, int port, const std::string& cacheDirectory)
+    : m_isSearching(false), m_http(host, port), m_cache(cacheDirectory),
+    m_index((std::filesystem::path(cacheDirectory) / "movie_index.bin").string()),
+    m_limiter((std::filesystem::path(cacheDirectory) / "omdb_quota.txt").string()) {
+    m_index.load();
+}
 
-MovieSearchService::MovieSearchService() : m_isSearching(false) {}
+MovieSearchService::~MovieSearchService()
+{
+    m_lifetime.cancel();    // running tasks finish without calling back
+    cancelSearch();         // also wakes pages waiting on the rate limiter
+    m_pool.shutdown();      // joins the workers, nothing outlives the service
+    m_index.save();
+}
 
-MovieSearchService::~MovieSearchService() = default;
+std::vector<Movie> MovieSearchService::searchLocal(const std::string& query, const std::string& year,
+    const std::string& genre, bool exactMatch, size_t limit) const
+{
+    auto equalsNoCase = [](const std::string& a, const std::string& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+            [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+    };
+
+    std::vector<Movie> results;
+    for (auto& movie : m_index.search(query, exactMatch ? limit * 4 : limit)) {
+        if (exactMatch && !equalsNoCase(movie.title, query)) continue;
+        if (year.length() == 4 && movie.year.compare(0, 4, year) != 0) continue;
+        if (!genre.empty() && !(movie.hasDetails && checkGenreMatch(movie.genre, genre))) continue;
+        results.push_back(std::move(movie));
+        if (results.size() == limit) break;
+    }
+    return results;
+}
 
 std::string MovieSearchService::encode_query(const std::string& query)  //encode the query
 {
@@ -42,169 +80,427 @@ bool MovieSearchService::checkGenreMatch(const std::string& movieGenre, const st
     return movieGenreLower.find(searchGenreLower) != std::string::npos;
 }
 
+// One running search. Pages and their hits keep the OMDB order so partial
+// results are always delivered in the same order as the final ones.
+struct MovieSearchService::SearchSession {
+    enum class Slot { Pending, Match, Rejected };
+
+    struct Page {
+        std::vector<Movie> movies;
+        std::vector<Slot> slots;
+    };
+
+    CancellationToken token;
+    std::string baseUrl;        // search url without the page parameter
+    std::string genre;
+    SearchCallback callback;
+
+    std::mutex mutex;
+    std::vector<Page> pages;
+    size_t pagesPending = 0;
+    std::deque<std::pair<size_t, size_t>> detailQueue;     // (page, hit) waiting for the genre check
+    size_t detailsInFlight = 0;
+};
+
 void MovieSearchService::searchMovies(
     const std::string& query,
     const std::string& year,
     const std::string& genre,
     bool exactMatch,
-    std::function<void(const std::vector<Movie>&, const std::string&)> callback)
+    SearchCallback callback)
 {
     if (query.empty()) {
-        callback({}, "Empty search query");
+        callback({}, StatusKind::EmptyQuery);
         return;
     }
 
-    std::thread([this, query, year, genre, exactMatch, callback]() {
-        std::vector<Movie> results;
-        std::string status;
+    auto session = std::make_shared<SearchSession>();
+    session->genre = genre;
+    session->callback = callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_currentSearch.cancel();       // a new query supersedes the running one
+        m_currentSearch = session->token;
+        m_isSearching = true;
+    }
 
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_isSearching = true;
-            status = "Searching...";
+    std::string searchUrl = "/?apikey=fb4a2231&" +
+		std::string(exactMatch ? "t=" : "s=") + encode_query(query);    //search the query
+
+	if (year.length() == 4) //search the year
+    {
+        searchUrl += "&y=" + year;
+    }
+
+    session->baseUrl = searchUrl;
+    if (!exactMatch) {
+        session->pages.resize(1);
+        session->pagesPending = 1;
+        m_pool.submit([this, session]() { fetchPage(session, 1); }, TaskPriority::Normal, session->token);
+        return;
+    }
+
+    m_pool.submit([this, session]() { fetchExact(session); }, TaskPriority::Normal, session->token);
+}
+
+void MovieSearchService::fetchExact(const std::shared_ptr<SearchSession>& session)
+{
+    std::vector<Movie> results;
+    StatusKind status;
+
+    OmdbResponse response;
+    ThreadPool::Clock::duration retryIn;
+    RequestResult result = requestOmdb(session->baseUrl, kSearchTtl, TaskPriority::Normal, response, retryIn);  //disk cache first, then the api domain
+    if (result == RequestResult::Deferred) {
+        m_pool.submitAfter(retryIn, [this, session]() { fetchExact(session); }, TaskPriority::Normal, session->token);
+        return;
+    }
+    if (result != RequestResult::Ok) {
+        status = failureStatus(result);
+    }
+    else if (response.ok) {
+        Movie movie = std::move(response.movie);    // the exact match has the full details
+        movie.hasDetails = true;
+        MovieCache::instance().put(movie);
+        m_index.add(movie);
+
+        if (checkGenreMatch(movie.genre, session->genre)) {
+            results.push_back(movie);
         }
+        status = StatusKind::SearchDone;
+    }
+    else {
+        status = StatusKind::NoResults;
+    }
+    m_pool.submit([this]() { m_index.saveIfDue(kIndexSaveInterval); }, TaskPriority::Low, m_lifetime);
 
-		httplib::Client cli("www.omdbapi.com"); //connect to the api domain
-        std::string searchUrl = "/?apikey=fb4a2231&" +
-			std::string(exactMatch ? "t=" : "s=") + encode_query(query);    //search the query
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (session->token.isCancelled() || m_lifetime.isCancelled()) return;
+    m_isSearching = false;
+    session->callback(results, status);
+}
 
-		if (year.length() == 4) //search the year
+StatusKind MovieSearchService::failureStatus(RequestResult result)
+{
+    return result == RequestResult::Throttled ? StatusKind::Throttled : StatusKind::SearchFailed;
+}
+
+void MovieSearchService::cancelSearch()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_currentSearch.cancel();
+    m_isSearching = false;
+}
+
+void MovieSearchService::fetchPage(const std::shared_ptr<SearchSession>& session, size_t pageNumber)
+{
+    std::string url = session->baseUrl;
+    if (pageNumber > 1) {
+        url += "&page=" + std::to_string(pageNumber);
+    }
+
+    std::vector<Movie> movies;
+    StatusKind error = StatusKind::None;
+    size_t totalResults = 0;
+    OmdbResponse response;
+    ThreadPool::Clock::duration retryIn;
+    RequestResult result = requestOmdb(url, kSearchTtl, TaskPriority::Normal, response, retryIn);  //disk cache first, then the api domain
+    if (result == RequestResult::Deferred) {    // the page stays pending, its worker is free meanwhile
+        m_pool.submitAfter(retryIn, [this, session, pageNumber]() { fetchPage(session, pageNumber); },
+            TaskPriority::Normal, session->token);
+        return;
+    }
+    if (result != RequestResult::Ok) {
+        error = failureStatus(result);
+    }
+    else if (response.ok) {
+        movies = std::move(response.hits);
+        for (auto& movie : movies) {
+            MovieCache::instance().get(movie.imdb_id, movie);    // seen before, reuse the full details
+            m_index.add(movie);
+        }
+        totalResults = response.totalResults;
+    }
+    else {
+        error = StatusKind::NoResults;
+    }
+
+    if (session->token.isCancelled()) return;
+
+    if (pageNumber == 1) {
+        if (error != StatusKind::None) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (session->token.isCancelled() || m_lifetime.isCancelled()) return;
+            m_isSearching = false;
+            session->callback({}, error);
+            return;
+        }
+
+        // OMDB returns 10 hits per page, prefetch the rest of the pages concurrently.
+        // Every page is an api request, so a broad query can't drain the daily quota
+        size_t pageCount = std::min((totalResults + 9) / 10, m_maxPages.load());
+        pageCount = std::min<size_t>(pageCount, 1 + m_limiter.stats().remainingToday / kPageQuotaShare);
+        pageCount = std::max<size_t>(pageCount, 1);
         {
-            searchUrl += "&y=" + year;
+            std::lock_guard<std::mutex> lock(session->mutex);
+            session->pages.resize(pageCount);
+            session->pagesPending += pageCount - 1;
+        }
+        for (size_t page = 2; page <= pageCount; ++page) {
+            m_pool.submit([this, session, page]() { fetchPage(session, page); },
+                TaskPriority::Normal, session->token);
         }
+    }
 
-        auto res = cli.Get(searchUrl.c_str());
-
-        if (res && res->status == 200) {
-            try {
-                std::cout << res->body << std::endl;
-                auto j = json::parse(res->body);
-                if (j["Response"] == "True") {
-                    if (exactMatch) 
-                    {
-                        Movie movie;
-                        movie.title = j.value("Title", "Unknown Title");
-                        movie.year = j.value("Year", "N/A");
-                        movie.imdb_id = j.value("imdbID", "");
-                        movie.poster_url = j.value("Poster", "N/A");
-                        movie.type = j.value("Type", "unknown");
-                        movie.plot = j.value("Plot", "N/A");
-                        movie.rating = j.value("imdbRating", "N/A");
-                        movie.actors = j.value("Actors", "N/A");
-                        movie.director = j.value("Director", "N/A");
-                        movie.genre = j.value("Genre", "N/A");
-                        movie.runtime = j.value("Runtime", "N/A");
-                        movie.released = j.value("Released", "N/A");
-                        movie.hasDetails = true;
-
-                        if (checkGenreMatch(movie.genre, genre)) {
-                            results.push_back(movie);
-                        }
-                    }
-                    else 
-                    {
-                        auto search_results = j["Search"];
-                        for (const auto& item : search_results) {
-                            Movie movie;
-                            movie.title = item.value("Title", "Unknown Title");
-                            movie.year = item.value("Year", "N/A");
-                            movie.imdb_id = item.value("imdbID", "");
-                            movie.poster_url = item.value("Poster", "N/A");
-                            movie.type = item.value("Type", "unknown");
-                            movie.hasDetails = false;
-
-							if (!genre.empty()) //search the full details
-                            {
-                                httplib::Client detail_cli("www.omdbapi.com");
-                                auto detail_res = detail_cli.Get(
-                                    ("/?apikey=fb4a2231&i=" + movie.imdb_id + "&plot=full").c_str());
-
-                                if (detail_res && detail_res->status == 200) {
-                                    auto detail_j = json::parse(detail_res->body);
-                                    if (detail_j["Response"] == "True") {
-                                        movie.genre = detail_j.value("Genre", "N/A");
-                                        if (checkGenreMatch(movie.genre, genre)) {
-                                            movie.plot = detail_j.value("Plot", "N/A");
-                                            movie.rating = detail_j.value("imdbRating", "N/A");
-                                            movie.actors = detail_j.value("Actors", "N/A");
-                                            movie.director = detail_j.value("Director", "N/A");
-                                            movie.runtime = detail_j.value("Runtime", "N/A");
-                                            movie.released = detail_j.value("Released", "N/A");
-                                            movie.hasDetails = true;
-                                            results.push_back(movie);
-                                        }
-                                    }
-                                }
-                            }
-                            else {
-                                results.push_back(movie);
-                            }
-                        }
-                    }
-                    status = "Found " + std::to_string(results.size()) + " results";
+    landPage(session, pageNumber - 1, std::move(movies));   // a failed later page lands empty
+}
+
+void MovieSearchService::landPage(const std::shared_ptr<SearchSession>& session, size_t pageIndex,
+    std::vector<Movie> movies)
+{
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        SearchSession::Page& page = session->pages[pageIndex];
+        page.movies = std::move(movies);
+        page.slots.assign(page.movies.size(), SearchSession::Slot::Match);
+
+		if (!session->genre.empty()) //the genre is only in the full details, check the hits concurrently
+        {
+            for (size_t i = 0; i < page.movies.size(); ++i) {
+                if (page.movies[i].hasDetails) {
+                    page.slots[i] = checkGenreMatch(page.movies[i].genre, session->genre) ?
+                        SearchSession::Slot::Match : SearchSession::Slot::Rejected;
                 }
                 else {
-                    status = "No results found";
+                    page.slots[i] = SearchSession::Slot::Pending;
+                    session->detailQueue.emplace_back(pageIndex, i);
                 }
             }
-            catch (const std::exception& e) {
-                status = "Error parsing response: " + std::string(e.what());
+        }
+
+        --session->pagesPending;
+        publish(session);
+    }
+
+    startNextDetails(session);
+}
+
+void MovieSearchService::startNextDetails(const std::shared_ptr<SearchSession>& session)
+{
+    while (true) {
+        std::pair<size_t, size_t> next;
+        Movie movie;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (session->token.isCancelled() || session->detailQueue.empty() ||
+                session->detailsInFlight >= m_maxDetailRequests) {
+                return;
             }
+            next = session->detailQueue.front();
+            session->detailQueue.pop_front();
+            ++session->detailsInFlight;
+            movie = session->pages[next.first].movies[next.second];
         }
-        else {
-            status = "Request failed!";
+
+        requestDetails(movie, TaskPriority::Normal, [this, session, next](const Movie& updated)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(session->mutex);
+                    --session->detailsInFlight;
+
+                    bool match = updated.hasDetails && checkGenreMatch(updated.genre, session->genre);
+                    SearchSession::Page& page = session->pages[next.first];
+                    page.movies[next.second] = updated;
+                    page.slots[next.second] = match ? SearchSession::Slot::Match : SearchSession::Slot::Rejected;
+                    publish(session);
+                }
+
+                startNextDetails(session);     // keep the in-flight window full
+            });
+    }
+}
+
+void MovieSearchService::publish(const std::shared_ptr<SearchSession>& session)
+{
+    // Called with the session lock held, so a partial list never overtakes a newer one
+    std::vector<Movie> results;
+    for (const auto& page : session->pages) {
+        for (size_t i = 0; i < page.movies.size(); ++i) {
+            if (page.slots[i] == SearchSession::Slot::Match) {
+                results.push_back(page.movies[i]);
+            }
         }
+    }
 
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_isSearching = false;
+    bool done = session->pagesPending == 0 && session->detailQueue.empty() && session->detailsInFlight == 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (session->token.isCancelled() || m_lifetime.isCancelled()) return;
+    if (done) {
+        m_isSearching = false;
+        m_pool.submit([this]() { m_index.saveIfDue(kIndexSaveInterval); }, TaskPriority::Low, m_lifetime);
+    }
+
+    session->callback(results, done ? StatusKind::SearchDone : StatusKind::Searching);
+}
+
+MovieSearchService::RequestResult MovieSearchService::requestOmdb(const std::string& url, std::chrono::seconds ttl,
+    TaskPriority priority, OmdbResponse& out, ThreadPool::Clock::duration& retryIn)
+{
+    // Parsed straight from the mapped cache file, the body is never copied
+    bool parsed = false;
+    auto reader = [&out, &parsed](const char* data, size_t size) {
+        parsed = parseOmdbResponse(data, size, out);
+        };
+    if (m_cache.lookup(url, reader) && parsed) return RequestResult::Ok;  // an unreadable entry goes to the network and is overwritten
+
+    // Out of budget, an expired answer from the cache beats none
+    RateLimiter::Admission admission = m_limiter.tryAcquire(priority, retryIn);
+    if (admission == RateLimiter::Admission::Wait) return RequestResult::Deferred;
+    if (admission == RateLimiter::Admission::Refused) {
+        parsed = false;
+        if (m_cache.lookup(url, reader, true) && parsed) {
+            ++m_staleResponses;
+            return RequestResult::Ok;
         }
+        return RequestResult::Throttled;
+    }
 
-        callback(results, status);
-        }).detach();
+    // The body is received in chunks into a per worker buffer that keeps its capacity
+    thread_local std::string body;
+    int status = m_http.getInto(url, body);     //pooled keep-alive connection to the api domain
+    if (status != 200 || !parseOmdbResponse(body.data(), body.size(), out)) return RequestResult::Failed;
+
+    if (out.ok) {   // errors like the daily limit are not cached
+        m_cache.store(url, body, ttl);
+    }
+    return RequestResult::Ok;
 }
 
-void MovieSearchService::fetchMovieDetails(Movie& movie,std::function<void(const Movie&)> callback)
-{ //fetch the movie details
+MovieSearchService::RequestResult MovieSearchService::fetchDetailsInto(Movie& movie, TaskPriority priority,
+    ThreadPool::Clock::duration& retryIn)
+{
+    if (movie.hasDetails || MovieCache::instance().get(movie.imdb_id, movie)) return RequestResult::Ok;
 
-    if (movie.hasDetails || movie.fetching) return;
+    OmdbResponse response;
+    RequestResult result = requestOmdb("/?apikey=fb4a2231&i=" + movie.imdb_id + "&plot=full", kDetailsTtl, priority, response, retryIn);
+    if (result != RequestResult::Ok) {
+        if (result == RequestResult::Failed) std::cout << "Error fetching details: " << movie.imdb_id << std::endl;
+        return result;
+    }
+    if (!response.ok) return RequestResult::Failed;
 
-    std::thread([this, &movie, callback]() 
-     {
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            movie.fetching = true;
+    // Only the details, the search fields of the caller's movie stay as they are
+    movie.plot = std::move(response.movie.plot);
+    movie.rating = std::move(response.movie.rating);
+    movie.actors = std::move(response.movie.actors);
+    movie.director = std::move(response.movie.director);
+    movie.genre = std::move(response.movie.genre);
+    movie.runtime = std::move(response.movie.runtime);
+    movie.released = std::move(response.movie.released);
+    movie.hasDetails = true;
+    MovieCache::instance().put(movie);
+    m_index.add(movie);     // plot, cast and director become searchable
+    return RequestResult::Ok;
+}
+
+// Followers wait for complete(), so a task that never runs (shutdown, failed
+// submit) or throws still finishes the flight, without details
+struct MovieSearchService::FlightGuard {
+    FlightGuard(MovieSearchService* service, const Movie& movie, TaskPriority priority)
+        : service(service), movie(movie), priority(priority) {}
+    FlightGuard(const FlightGuard&) = delete;
+    ~FlightGuard() { if (!finished) service->finishFlight(movie, priority, false); }
+
+    MovieSearchService* service;
+    Movie movie;
+    TaskPriority priority;
+    bool finished = false;
+};
+
+void MovieSearchService::requestDetails(const Movie& movie, TaskPriority priority,
+    std::function<void(const Movie&)> callback)
+{
+    // Only the first caller for an imdb_id sends the request, the rest wait for its result.
+    // A more urgent caller promotes the flight with a task at its own priority
+    {
+        std::lock_guard<std::mutex> lock(m_flightMutex);
+        bool leader = m_detailFlights.join(movie.imdb_id, std::move(callback));
+        auto running = m_flightPriority.find(movie.imdb_id);
+        if (!leader && (running == m_flightPriority.end() || running->second >= priority)) return;
+        m_flightPriority[movie.imdb_id] = priority;
+    }
+
+    auto guard = std::make_shared<FlightGuard>(this, movie, priority);
+    uint64_t epoch = m_prefetchEpoch;
+    m_pool.submit([this, guard, epoch]() { runFlight(guard, epoch); }, priority, m_lifetime);
+}
+
+void MovieSearchService::runFlight(const std::shared_ptr<FlightGuard>& guard, uint64_t epoch)
+{
+    Movie result = guard->movie;
+    TaskPriority priority = guard->priority;
+    bool stale = priority == TaskPriority::Low && epoch != m_prefetchEpoch;  // the list it was for is gone
+    RequestResult fetched = RequestResult::Failed;
+    if (!stale) {
+        ThreadPool::Clock::duration retryIn;
+        fetched = fetchDetailsInto(result, priority, retryIn);
+        if (fetched == RequestResult::Deferred) {   // the guard rides along, shutdown still completes the flight
+            m_pool.submitAfter(retryIn, [this, guard, epoch]() { runFlight(guard, epoch); }, priority, m_lifetime);
+            return;
         }
+    }
+    guard->finished = true;
+    finishFlight(std::move(result), priority, fetched == RequestResult::Ok);
+}
 
-        httplib::Client cli("www.omdbapi.com");
-        auto res = cli.Get(("/?apikey=fb4a2231&i=" + movie.imdb_id + "&plot=full").c_str());
-
-        if (res && res->status == 200) {
-            try {
-                std::cout << res->body << std::endl;
-
-                auto j = json::parse(res->body);
-                if (j["Response"] == "True") {
-                    movie.plot = j.value("Plot", "N/A");
-                    movie.rating = j.value("imdbRating", "N/A");
-                    movie.actors = j.value("Actors", "N/A");
-                    movie.director = j.value("Director", "N/A");
-                    movie.genre = j.value("Genre", "N/A");
-                    movie.runtime = j.value("Runtime", "N/A");
-                    movie.released = j.value("Released", "N/A");
-                    movie.hasDetails = true;
-                }
-            }
-            catch (const std::exception& e) {
-                std::cout << "Error fetching details: " << e.what() << std::endl;
-            }
+void MovieSearchService::finishFlight(Movie result, TaskPriority priority, bool fetched)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_flightMutex);
+        auto running = m_flightPriority.find(result.imdb_id);
+        if (running != m_flightPriority.end()) {
+            if (!fetched && running->second > priority) return;    // promoted, the urgent task completes it
+            m_flightPriority.erase(running);
         }
+    }
+    result.fetching = false;
+    m_detailFlights.complete(result.imdb_id, result);
+}
+
+void MovieSearchService::prefetchDetails(const Movie& movie, std::function<void(const Movie&)> callback)
+{
+    Movie cached = movie;
+    if (movie.hasDetails || MovieCache::instance().get(movie.imdb_id, cached)) {
+        callback(cached);
+        return;
+    }
 
+    requestDetails(movie, TaskPriority::Low, [this, callback](const Movie& result)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            movie.fetching = false;
-        }
+            if (m_lifetime.isCancelled()) return;
+            callback(result);
+        });
+}
+
+void MovieSearchService::cancelPrefetch()
+{
+    ++m_prefetchEpoch;  // queued prefetches finish without a request, promoted ones still run
+}
 
-        callback(movie);
-        }).detach();
+void MovieSearchService::fetchMovieDetails(Movie& movie,std::function<void(const Movie&)> callback)
+{ //fetch the movie details
+
+    if (movie.hasDetails || movie.fetching) return;
+
+    if (MovieCache::instance().get(movie.imdb_id, movie)) return;   // filled in place, no request needed
+
+    movie.fetching = true;  // set by the caller under its own lock
+    Movie request = movie;  // the worker never touches the caller's movie
+
+    requestDetails(request, TaskPriority::High, [this, callback](const Movie& result)
+     {
+        if (m_lifetime.isCancelled()) return;
+        callback(result);
+        });
 }
\ No newline at end of file
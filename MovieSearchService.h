@@ -3,29 +3,121 @@
 #include <vector>
 #include <functional>
 #include <mutex>
-#include <thread>
-#include "Movie.h"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include "movie.h"
+#include "ThreadPool.h"
+#include "HttpClientPool.h"
+#include "ResponseCache.h"
+#include "SingleFlight.h"
+#include "OmdbParser.h"
+#include "MovieIndex.h"
+#include "RateLimiter.h"
+#include "StatusEvents.h"
 
 class MovieSearchService {
 public:
-    MovieSearchService();
+    using SearchCallback = std::function<void(const std::vector<Movie>&, StatusKind)>;
+
+    // The endpoint defaults to the public api, benchmarks point it at a local stub
+    explicit MovieSearchService(const std::string& host = "www.omdbapi.com", int port = 80,
+        const std::string& cacheDirectory = "omdb_cache");
     ~MovieSearchService();
 
+    // Results are streamed: the callback is called again with the full list
+    // so far every time a page or a genre match arrives (StatusKind::Searching),
+    // the last call has the final status. A new search cancels the old one.
     void searchMovies(const std::string& query,
         const std::string& year,
         const std::string& genre,
         bool exactMatch,
-        std::function<void(const std::vector<Movie>&, const std::string&)> callback);
+        SearchCallback callback);
 
+    // Marks the movie as fetching and loads the details on the pool.
+    // The worker fills a copy, the callback gets the updated movie.
+    // Details already in MovieCache are filled in place without a callback.
+    // Concurrent calls for the same imdb_id share one request.
     void fetchMovieDetails(Movie& movie,
         std::function<void(const Movie&)> callback);
 
+    // Low priority details for a row the user may open next. Opening it
+    // (fetchMovieDetails) promotes the request to High. The callback gets
+    // the movie without details when the budget is spent or the prefetch
+    // was cancelled before it ran; cached details come back at once
+    void prefetchDetails(const Movie& movie, std::function<void(const Movie&)> callback);
+    void cancelPrefetch();     // drops the prefetches still queued
+
+    // Instant answer from the local index of every movie seen so far,
+    // same filters as searchMovies. Runs on the calling thread
+    std::vector<Movie> searchLocal(const std::string& query,
+        const std::string& year,
+        const std::string& genre,
+        bool exactMatch,
+        size_t limit = 100) const;
+    size_t localIndexSize() const { return m_index.size(); }
+
+    void cancelSearch();
     bool isSearching() const { return m_isSearching; }
 
+    ThreadPool& executor() { return m_pool; }  // shared pool for other background work
+    HttpPoolStats httpStats() const { return m_http.stats(); }
+    uint64_t coalescedDetailRequests() const { return m_detailFlights.coalescedCount(); }
+    ResponseCacheStats cacheStats() const { return m_cache.stats(); }
+
+    // Api budget. Opened details wait for a token before search pages, and
+    // prefetch is dropped when there is none. Throttled requests are
+    // answered from the cache even when the entry has expired
+    RateLimiterStats quotaStats() const { return m_limiter.stats(); }
+    uint64_t staleResponses() const { return m_staleResponses; }
+    void setRateLimit(double requestsPerSecond, double burst) { m_limiter.setRate(requestsPerSecond, burst); }
+    void setDailyQuota(uint32_t requests) { m_limiter.setDailyLimit(requests); }
+
+    // How many genre detail requests one search keeps in flight
+    void setMaxDetailRequests(size_t count) { m_maxDetailRequests = count ? count : 1; }
+    // How many result pages (10 hits each) one search reads at most, also
+    // capped by the daily quota that is left
+    void setMaxPages(size_t count) { m_maxPages = count ? count : 1; }
+
+    static std::string encode_query(const std::string& query);  // public for the benchmarks
+
 private:
-    std::string encode_query(const std::string& query);
-    bool checkGenreMatch(const std::string& movieGenre, const std::string& searchGenre);
+    static bool checkGenreMatch(const std::string& movieGenre, const std::string& searchGenre);
+    // Deferred: no rate limiter token yet, the calling task submits itself
+    // again after retryIn instead of blocking its worker
+    enum class RequestResult { Ok, Failed, Throttled, Deferred };
+    static StatusKind failureStatus(RequestResult result);
+    RequestResult requestOmdb(const std::string& url, std::chrono::seconds ttl, TaskPriority priority,
+        OmdbResponse& out, ThreadPool::Clock::duration& retryIn);
+    RequestResult fetchDetailsInto(Movie& movie, TaskPriority priority, ThreadPool::Clock::duration& retryIn);
+    void requestDetails(const Movie& movie, TaskPriority priority, std::function<void(const Movie&)> callback);
+    struct FlightGuard;
+    void runFlight(const std::shared_ptr<FlightGuard>& guard, uint64_t epoch);
+    void finishFlight(Movie result, TaskPriority priority, bool fetched);     // completes unless a promoted task owns it
+
+    struct SearchSession;
+    void fetchExact(const std::shared_ptr<SearchSession>& session);
+    void fetchPage(const std::shared_ptr<SearchSession>& session, size_t pageNumber);
+    void landPage(const std::shared_ptr<SearchSession>& session, size_t pageIndex, std::vector<Movie> movies);
+    void startNextDetails(const std::shared_ptr<SearchSession>& session);
+    void publish(const std::shared_ptr<SearchSession>& session);
+
+    mutable std::mutex m_mutex;     // guards m_currentSearch and orders the search callbacks
+    std::atomic<bool> m_isSearching;
+    CancellationToken m_currentSearch;
+    std::atomic<size_t> m_maxDetailRequests{ 4 };
+    std::atomic<size_t> m_maxPages{ 3 };
+    std::atomic<uint64_t> m_staleResponses{ 0 };
+    std::atomic<uint64_t> m_prefetchEpoch{ 0 };
+
+    std::mutex m_flightMutex;       // orders joins with the priorities below
+    std::unordered_map<std::string, TaskPriority> m_flightPriority;     // highest task started per detail flight
 
-    mutable std::mutex m_mutex;
-    bool m_isSearching;
-};
\ No newline at end of file
+    HttpClientPool m_http;          // keep-alive connections to the api domain
+    ResponseCache m_cache;          // raw responses on disk, checked before m_http
+    SingleFlight<Movie> m_detailFlights;    // outstanding detail requests by imdb_id
+    MovieIndex m_index;             // every movie seen, persisted next to the response cache
+    RateLimiter m_limiter;          // token bucket and daily quota, checked after the cache
+    CancellationToken m_lifetime;   // cancelled in the destructor, skips late callbacks
+    ThreadPool m_pool;              // declared last so it is joined first
+};
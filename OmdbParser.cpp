@@ -0,0 +1,163 @@
+#include "OmdbParser.h"
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+struct FieldMapping {
+    const char* key;
+    std::string Movie::* member;
+};
+
+// Fields of a "Search" entry
+const FieldMapping kHitFields[] = {
+    { "Title", &Movie::title },
+    { "Year", &Movie::year },
+    { "imdbID", &Movie::imdb_id },
+    { "Poster", &Movie::poster_url },
+    { "Type", &Movie::type },
+};
+
+// Fields of a full movie response, the hit fields plus the details
+const FieldMapping kMovieFields[] = {
+    { "Title", &Movie::title },
+    { "Year", &Movie::year },
+    { "imdbID", &Movie::imdb_id },
+    { "Poster", &Movie::poster_url },
+    { "Type", &Movie::type },
+    { "Plot", &Movie::plot },
+    { "imdbRating", &Movie::rating },
+    { "Actors", &Movie::actors },
+    { "Director", &Movie::director },
+    { "Genre", &Movie::genre },
+    { "Runtime", &Movie::runtime },
+    { "Released", &Movie::released },
+};
+
+void setHitDefaults(Movie& movie) {
+    movie.title = "Unknown Title";
+    movie.year = "N/A";
+    movie.imdb_id.clear();
+    movie.poster_url = "N/A";
+    movie.type = "unknown";
+}
+
+void setDefaults(Movie& movie) {
+    setHitDefaults(movie);
+    movie.plot = movie.rating = movie.actors = movie.director = "N/A";
+    movie.genre = movie.runtime = movie.released = "N/A";
+}
+
+template <size_t N>
+std::string* findField(const FieldMapping (&fields)[N], Movie& movie, const std::string& key) {
+    for (const auto& field : fields) {
+        if (key == field.key) return &(movie.*field.member);
+    }
+    return nullptr;
+}
+
+// Depth 1 is the response object. "Search" is an array at depth 2 and
+// its entries are objects at depth 3, anything else deeper is skipped.
+class OmdbSaxHandler : public nlohmann::json_sax<json> {
+public:
+    explicit OmdbSaxHandler(OmdbResponse& out) : m_out(out) {}
+
+    bool null() override { return value(); }
+    bool boolean(bool) override { return value(); }
+    bool number_integer(number_integer_t) override { return value(); }
+    bool number_unsigned(number_unsigned_t) override { return value(); }
+    bool number_float(number_float_t, const string_t&) override { return value(); }
+    bool binary(binary_t&) override { return value(); }
+
+    bool string(string_t& text) override {
+        if (m_target) {
+            *m_target = std::move(text);
+        }
+        else if (m_special == Special::Response) {
+            m_out.ok = text == "True";
+        }
+        else if (m_special == Special::TotalResults) {
+            m_out.totalResults = std::strtoul(text.c_str(), nullptr, 10);
+        }
+        return value();
+    }
+
+    bool start_object(std::size_t) override {
+        ++m_depth;
+        if (m_inSearch && m_depth == 3) {
+            m_out.hits.emplace_back();
+            setHitDefaults(m_out.hits.back());     // the details stay empty until fetched
+        }
+        return value();
+    }
+
+    bool end_object() override {
+        --m_depth;
+        return value();
+    }
+
+    bool start_array(std::size_t) override {
+        ++m_depth;
+        if (m_depth == 2 && m_special == Special::Search) {
+            m_inSearch = true;
+            m_out.hits.reserve(10);     // OMDB pages have 10 hits
+        }
+        return value();
+    }
+
+    bool end_array() override {
+        if (m_depth == 2) {
+            m_inSearch = false;
+        }
+        --m_depth;
+        return value();
+    }
+
+    bool key(string_t& name) override {
+        m_target = nullptr;
+        m_special = Special::None;
+
+        if (m_depth == 1) {
+            if (name == "Response") m_special = Special::Response;
+            else if (name == "Error") m_target = &m_out.error;
+            else if (name == "totalResults") m_special = Special::TotalResults;
+            else if (name == "Search") m_special = Special::Search;
+            else m_target = findField(kMovieFields, m_out.movie, name);
+        }
+        else if (m_inSearch && m_depth == 3) {
+            m_target = findField(kHitFields, m_out.hits.back(), name);
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+
+private:
+    enum class Special { None, Response, TotalResults, Search };
+
+    // Every value ends the key it belonged to
+    bool value() {
+        m_target = nullptr;
+        m_special = Special::None;
+        return true;
+    }
+
+    OmdbResponse& m_out;
+    int m_depth = 0;
+    bool m_inSearch = false;
+    std::string* m_target = nullptr;
+    Special m_special = Special::None;
+};
+
+}
+
+bool parseOmdbResponse(const char* data, size_t size, OmdbResponse& out) {
+    out = OmdbResponse();
+    setDefaults(out.movie);
+
+    OmdbSaxHandler handler(out);
+    return json::sax_parse(data, data + size, &handler);
+}
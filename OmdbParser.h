@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "movie.h"
+
+// The fields of an OMDB response the app uses
+struct OmdbResponse {
+    bool ok = false;            // "Response": "True"
+    std::string error;          // "Error" when not ok
+    size_t totalResults = 0;    // search responses
+    std::vector<Movie> hits;    // "Search" entries, hasDetails false
+    Movie movie;                // top level fields of a "t=" or "i=" response
+};
+
+// SAX parse straight into OmdbResponse, no json DOM is built. Fields the
+// app does not use ("Ratings", "Metascore", ...) are skipped. Missing
+// fields get the same defaults the DOM code used ("N/A", "Unknown Title").
+// Returns false for malformed JSON.
+bool parseOmdbResponse(const char* data, size_t size, OmdbResponse& out);
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+
+// Desktop actions the app asks for. The Win32 frontend hands urls to the
+// shell, headless runs record them instead, so the app itself needs no
+// platform headers. Frontends that only draw on input also need to hear
+// about changes made off the UI thread.
+class PlatformServices {
+public:
+    virtual ~PlatformServices() = default;
+
+    virtual void openUrl(const std::string& url) = 0;     // imdb pages, posters
+    virtual void requestFrame() {}                          // any thread, something the UI shows changed
+    virtual void requestFrameAfter(double /*seconds*/) {}   // UI thread, e.g. the search debounce
+};
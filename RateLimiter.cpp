@@ -0,0 +1,204 @@
+#include "RateLimiter.h"
+#include "FileUtil.h"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+
+namespace {
+    const double kLowPriorityReserve = 0.1;     // share of the daily quota Low priority never spends
+    const std::chrono::milliseconds kMaxWaitSlice(100);     // waiters look at their token this often
+    const std::chrono::milliseconds kRetrySlack(20);        // time a rescheduled task gets to reach a worker
+    const uint32_t kSaveEvery = 8;      // requests between quota file writes, a crash undercounts at most this
+}
+
+RateLimiter::RateLimiter(const std::string& quotaFile, double ratePerSecond, double burst, uint32_t dailyLimit)
+    : m_quotaFile(quotaFile), m_rate(ratePerSecond), m_burst(burst), m_tokens(burst),
+    m_lastRefill(Clock::now()), m_dailyLimit(dailyLimit) {
+    loadQuota();
+}
+
+RateLimiter::~RateLimiter() {
+    bool changed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        changed = m_usedToday != m_savedCount;
+    }
+    if (changed) saveQuota();
+}
+
+std::time_t RateLimiter::nextUtcMidnight(std::time_t now) {
+    const std::time_t day = 24 * 60 * 60;     // epoch time has no leap seconds
+    return now - now % day + day;
+}
+
+std::string RateLimiter::today() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    char day[16];
+    std::strftime(day, sizeof(day), "%Y-%m-%d", &utc);
+    return day;
+}
+
+void RateLimiter::loadQuota() {
+    std::ifstream file(m_quotaFile);
+    std::string day;
+    uint32_t used = 0;
+    m_dayEnd = nextUtcMidnight(std::time(nullptr));
+    if (file >> day >> used && day == today()) {
+        m_day = day;
+        m_usedToday = used;
+        m_savedCount = used;
+    }
+    else {
+        m_day = today();
+        m_usedToday = 0;
+    }
+}
+
+void RateLimiter::saveQuota() {
+    // The counters are read after taking the file lock, so a slow writer
+    // never puts an older count over a newer one
+    std::lock_guard<std::mutex> fileLock(m_fileMutex);
+    std::string day;
+    uint32_t used;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        day = m_day;
+        used = m_usedToday;
+        m_savedCount = used;
+    }
+    // Temp file and rename, a crash never leaves a torn count that resets the day
+    writeFileAtomic(m_quotaFile, day + ' ' + std::to_string(used) + '\n');
+}
+
+void RateLimiter::rollDay() {
+    std::time_t now = std::time(nullptr);
+    if (now >= m_dayEnd) {
+        m_day = today();
+        m_dayEnd = nextUtcMidnight(now);
+        m_usedToday = 0;
+        m_savedCount = 0;
+    }
+}
+
+uint32_t RateLimiter::limitFor(TaskPriority priority) const {
+    uint32_t limit = m_dailyLimit;
+    if (priority == TaskPriority::Low) {
+        limit -= static_cast<uint32_t>(m_dailyLimit * kLowPriorityReserve);
+    }
+    return limit;
+}
+
+void RateLimiter::refill(Clock::time_point now) {
+    std::chrono::duration<double> elapsed = now - m_lastRefill;
+    m_tokens = std::min(m_burst, m_tokens + elapsed.count() * m_rate);
+    m_lastRefill = now;
+}
+
+bool RateLimiter::higherWaiting(TaskPriority priority, Clock::time_point now) const {
+    for (int p = static_cast<int>(priority) + 1; p < 3; ++p) {
+        if (m_waiting[p] || m_retryDue[p] > now) return true;
+    }
+    return false;
+}
+
+bool RateLimiter::take() {
+    m_tokens -= 1.0;
+    ++m_usedToday;
+    ++m_granted;
+    bool save = m_usedToday - m_savedCount >= kSaveEvery;
+    if (save) m_savedCount = m_usedToday;   // one writer per batch
+    m_cv.notify_all();      // the next waiter may be allowed now
+    return save;
+}
+
+RateLimiter::Clock::duration RateLimiter::untilToken() const {
+    auto wait = std::chrono::duration<double>(m_tokens >= 1.0 ? 0.0 : (1.0 - m_tokens) / m_rate);
+    wait = std::min<std::chrono::duration<double>>(wait, kMaxWaitSlice);
+    return std::max<Clock::duration>(std::chrono::duration_cast<Clock::duration>(wait), std::chrono::milliseconds(1));
+}
+
+bool RateLimiter::acquire(TaskPriority priority, const CancellationToken& token) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    int level = static_cast<int>(priority);
+    ++m_waiting[level];
+    while (true) {
+        // Checked on every pass, waiters queued behind the last request of the day must not overrun it
+        rollDay();
+        if (m_usedToday >= limitFor(priority)) break;
+        Clock::time_point now = Clock::now();
+        refill(now);
+        if (token.isCancelled()) break;
+        if (m_tokens >= 1.0 && !higherWaiting(priority, now)) {
+            --m_waiting[level];
+            bool save = take();
+            lock.unlock();
+
+            if (save) saveQuota();
+            return true;
+        }
+        if (priority == TaskPriority::Low) break;   // speculative work is dropped, not queued
+
+        m_cv.wait_for(lock, untilToken());
+    }
+    --m_waiting[level];
+    m_cv.notify_all();
+    if (!token.isCancelled()) ++m_throttled;    // a dropped search is not a refusal
+    return false;
+}
+
+RateLimiter::Admission RateLimiter::tryAcquire(TaskPriority priority, Clock::duration& retryIn) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    rollDay();
+    if (m_usedToday < limitFor(priority)) {
+        Clock::time_point now = Clock::now();
+        refill(now);
+        if (m_tokens >= 1.0 && !higherWaiting(priority, now)) {
+            bool save = take();
+            lock.unlock();
+
+            if (save) saveQuota();
+            return Admission::Granted;
+        }
+        if (priority != TaskPriority::Low) {    // speculative work is dropped, not queued
+            retryIn = untilToken();
+            // Until the retry runs, lower priorities leave the tokens alone
+            int level = static_cast<int>(priority);
+            m_retryDue[level] = std::max(m_retryDue[level], now + retryIn + kRetrySlack);
+            return Admission::Wait;
+        }
+    }
+    ++m_throttled;
+    return Admission::Refused;
+}
+
+void RateLimiter::setRate(double ratePerSecond, double burst) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    refill(Clock::now());
+    m_rate = ratePerSecond > 0.0 ? ratePerSecond : 1.0;
+    m_burst = std::max(burst, 1.0);
+    m_tokens = std::min(m_tokens, m_burst);
+    m_cv.notify_all();
+}
+
+void RateLimiter::setDailyLimit(uint32_t limit) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dailyLimit = limit;
+}
+
+RateLimiterStats RateLimiter::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RateLimiterStats stats;
+    stats.dailyLimit = m_dailyLimit;
+    stats.usedToday = std::time(nullptr) < m_dayEnd ? m_usedToday : 0;
+    stats.remainingToday = stats.usedToday < m_dailyLimit ? m_dailyLimit - stats.usedToday : 0;
+    stats.granted = m_granted;
+    stats.throttled = m_throttled;
+    return stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include "ThreadPool.h"
+
+struct RateLimiterStats {
+    uint32_t dailyLimit = 0;
+    uint32_t usedToday = 0;
+    uint32_t remainingToday = 0;
+    uint64_t granted = 0;
+    uint64_t throttled = 0;     // requests refused: quota spent, or no token for speculative work (cancellations not counted)
+};
+
+// Client side budget for the api: a token bucket for bursts and a daily
+// quota persisted in a small text file ("yyyy-mm-dd count", UTC days,
+// written every few requests and on destruction).
+// Callers wait for a token in priority order, High before Normal before
+// Low. Low priority work never waits and leaves a reserve of the daily
+// quota to the requests the user is waiting on.
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+    enum class Admission { Granted, Wait, Refused };
+
+    explicit RateLimiter(const std::string& quotaFile = "omdb_quota.txt",
+        double ratePerSecond = 5.0, double burst = 10.0, uint32_t dailyLimit = 1000);
+    ~RateLimiter();
+
+    // True when the request may go out. False when the quota is spent,
+    // when Low priority finds no token, or when token is cancelled
+    bool acquire(TaskPriority priority, const CancellationToken& token);
+    // Same rules without blocking, for pool tasks: on Wait the caller
+    // reschedules itself after retryIn instead of holding its worker.
+    // A Wait holds back lower priorities until the retry is due
+    Admission tryAcquire(TaskPriority priority, Clock::duration& retryIn);
+
+    void setRate(double ratePerSecond, double burst);
+    void setDailyLimit(uint32_t limit);
+    RateLimiterStats stats() const;
+
+private:
+    void refill(Clock::time_point now);
+    bool take();    // call with m_mutex held and a token available, true when the count should be saved
+    Clock::duration untilToken() const;
+    void rollDay();
+    void loadQuota();
+    void saveQuota();       // call without m_mutex, writes the latest count
+    bool higherWaiting(TaskPriority priority, Clock::time_point now) const;
+    uint32_t limitFor(TaskPriority priority) const;
+    static std::string today();
+    static std::time_t nextUtcMidnight(std::time_t now);
+
+    std::string m_quotaFile;
+    mutable std::mutex m_mutex;
+    std::mutex m_fileMutex;     // orders quota file writes, taken before m_mutex
+    std::condition_variable m_cv;
+
+    double m_rate;
+    double m_burst;
+    double m_tokens;
+    Clock::time_point m_lastRefill;
+
+    uint32_t m_dailyLimit;
+    uint32_t m_usedToday = 0;
+    uint32_t m_savedCount = 0;      // m_usedToday as last written
+    std::string m_day;
+    std::time_t m_dayEnd = 0;       // start of the next UTC day, so the hot paths skip gmtime
+
+    size_t m_waiting[3] = { 0, 0, 0 };  // blocked waiters per TaskPriority
+    Clock::time_point m_retryDue[3];    // latest retry promised to a tryAcquire Wait, per TaskPriority
+    uint64_t m_granted = 0;
+    uint64_t m_throttled = 0;
+};
@@ -0,0 +1,230 @@
+#include "ResponseCache.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct CacheFileHeader {
+    char magic[4];          // "ORC1"
+    uint32_t keyLength;
+    int64_t expiresAt;      // unix time in seconds
+    uint64_t bodySize;
+};
+
+const char kMagic[4] = { 'O', 'R', 'C', '1' };
+const char* kExtension = ".cache";
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint64_t fnv1a(const std::string& text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+}
+
+ResponseCache::ResponseCache(const std::string& directory, size_t maxBytes)
+    : m_directory(directory), m_maxBytes(maxBytes) {
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+    loadIndex();
+}
+
+std::string ResponseCache::normalizeUrl(const std::string& url) {
+    size_t queryPos = url.find('?');
+    if (queryPos == std::string::npos) return url;
+
+    std::vector<std::string> params;
+    size_t start = queryPos + 1;
+    while (start <= url.size()) {
+        size_t end = url.find('&', start);
+        if (end == std::string::npos) end = url.size();
+
+        std::string param = url.substr(start, end - start);
+        std::transform(param.begin(), param.end(), param.begin(), ::tolower);
+        if (!param.empty() && param.compare(0, 7, "apikey=") != 0) {
+            params.push_back(param);
+        }
+        start = end + 1;
+    }
+    std::sort(params.begin(), params.end());
+
+    std::string normalized = url.substr(0, queryPos + 1);
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (i > 0) normalized += '&';
+        normalized += params[i];
+    }
+    return normalized;
+}
+
+std::string ResponseCache::fileNameFor(const std::string& key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(fnv1a(key)));
+    return std::string(name) + kExtension;
+}
+
+void ResponseCache::loadIndex() {
+    struct Found {
+        fs::file_time_type time;
+        std::string name;
+        uint64_t size;
+    };
+    std::vector<Found> found;
+
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(m_directory, ec)) {
+        if (!item.is_regular_file(ec)) continue;
+
+        std::string name = item.path().filename().string();
+        if (item.path().extension() == kExtension) {
+            found.push_back({ item.last_write_time(ec), name, item.file_size(ec) });
+        }
+        else if (name.find(".tmp") != std::string::npos) {
+            fs::remove(item.path(), ec);    // left over from an interrupted write
+        }
+    }
+
+    // Newest first, that is the order of the LRU list
+    std::sort(found.begin(), found.end(),
+        [](const Found& a, const Found& b) { return a.time > b.time; });
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& f : found) {
+        m_lru.push_back(f.name);
+        m_entries[f.name] = Entry{ std::prev(m_lru.end()), f.size };
+        m_totalBytes += f.size;
+    }
+    evictOverCap();
+}
+
+void ResponseCache::touch(const std::string& fileName) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(fileName);
+    if (it != m_entries.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+    }
+}
+
+void ResponseCache::record(const std::string& fileName, uint64_t size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(fileName);
+    if (it != m_entries.end()) {
+        m_totalBytes -= it->second.size;
+        m_lru.erase(it->second.lruPosition);
+    }
+    m_lru.push_front(fileName);
+    m_entries[fileName] = Entry{ m_lru.begin(), size };
+    m_totalBytes += size;
+    evictOverCap();
+}
+
+void ResponseCache::evictOverCap() {   // called with m_mutex held
+    while (m_totalBytes > m_maxBytes && !m_lru.empty()) {
+        std::string victim = m_lru.back();
+        m_lru.pop_back();
+
+        auto it = m_entries.find(victim);
+        m_totalBytes -= it->second.size;
+        m_entries.erase(it);
+
+        std::error_code ec;
+        fs::remove(fs::path(m_directory) / victim, ec);
+        ++m_evictions;
+    }
+}
+
+bool ResponseCache::lookup(const std::string& url, const Reader& reader, bool allowExpired) {
+    std::string key = normalizeUrl(url);
+    std::string fileName = fileNameFor(key);
+
+    MappedFile file((fs::path(m_directory) / fileName).string());
+    if (!file.isOpen() || file.size() < sizeof(CacheFileHeader)) {
+        ++m_misses;
+        return false;
+    }
+
+    CacheFileHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+
+    bool valid = memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+        file.size() == sizeof(header) + header.keyLength + header.bodySize &&
+        key.compare(0, std::string::npos, file.data() + sizeof(header), header.keyLength) == 0;
+    if (!valid) {
+        ++m_misses;     // corrupt entry or a hash collision, the next store replaces it
+        return false;
+    }
+
+    if (!allowExpired && header.expiresAt < unixNow()) {
+        ++m_misses;
+        return false;
+    }
+
+    ++m_hits;
+    touch(fileName);
+    reader(file.data() + sizeof(header) + header.keyLength, static_cast<size_t>(header.bodySize));
+    return true;
+}
+
+void ResponseCache::store(const std::string& url, const std::string& body, std::chrono::seconds ttl) {
+    static std::atomic<uint64_t> tempCounter{ 0 };
+
+    std::string key = normalizeUrl(url);
+    std::string fileName = fileNameFor(key);
+    fs::path finalPath = fs::path(m_directory) / fileName;
+    fs::path tempPath = fs::path(m_directory) / (fileName + ".tmp" + std::to_string(tempCounter++));
+
+    CacheFileHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.keyLength = static_cast<uint32_t>(key.size());
+    header.expiresAt = unixNow() + ttl.count();
+    header.bodySize = body.size();
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(key.data(), key.size());
+        out.write(body.data(), body.size());
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    // Readers see either the old entry or the new one, never a partial file
+    std::error_code ec;
+    fs::rename(tempPath, finalPath, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);   // the old entry is still mapped somewhere (Windows)
+        return;
+    }
+
+    ++m_stores;
+    record(fileName, sizeof(header) + key.size() + body.size());
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    ResponseCacheStats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.stores = m_stores;
+    s.evictions = m_evictions;
+    return s;
+}
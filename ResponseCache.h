@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct ResponseCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+// Disk cache of raw OMDB response bodies keyed by the normalized request url.
+// Every entry is one file (header + key + body) written atomically through a
+// temp file and rename. Reads map the file, so a hit never copies the body.
+class ResponseCache {
+public:
+    using Reader = std::function<void(const char* data, size_t size)>;
+
+    explicit ResponseCache(const std::string& directory = "omdb_cache",
+        size_t maxBytes = 64 * 1024 * 1024);
+
+    // Calls reader with the cached body and returns true on a fresh hit.
+    // allowExpired also accepts entries past their TTL (offline fallback).
+    bool lookup(const std::string& url, const Reader& reader, bool allowExpired = false);
+    void store(const std::string& url, const std::string& body, std::chrono::seconds ttl);
+
+    ResponseCacheStats stats() const;
+
+    // Drops the api key, lowercases and sorts the query parameters
+    static std::string normalizeUrl(const std::string& url);
+
+private:
+    struct Entry {
+        std::list<std::string>::iterator lruPosition;
+        uint64_t size;
+    };
+
+    std::string fileNameFor(const std::string& key) const;
+    void loadIndex();
+    void touch(const std::string& fileName);
+    void record(const std::string& fileName, uint64_t size);
+    void evictOverCap();
+
+    std::string m_directory;
+    size_t m_maxBytes;
+
+    std::mutex m_mutex;                         // guards the index below
+    std::list<std::string> m_lru;               // most recently used at the front
+    std::unordered_map<std::string, Entry> m_entries;
+    uint64_t m_totalBytes = 0;
+
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+    std::atomic<uint64_t> m_stores{ 0 };
+    std::atomic<uint64_t> m_evictions{ 0 };
+};
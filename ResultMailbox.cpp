@@ -0,0 +1,44 @@
+#include "ResultMailbox.h"
+
+void ResultMailbox::publish(std::shared_ptr<ResultSnapshot> snapshot) {
+    std::shared_ptr<ResultSnapshot> pending = std::atomic_load(&m_pending);
+    do {
+        // A late worker of a superseded query must not push out the newer list
+        if (pending && pending->generation > snapshot->generation) return;
+    } while (!std::atomic_compare_exchange_weak(&m_pending, &pending, snapshot));
+}
+
+std::shared_ptr<ResultSnapshot> ResultMailbox::take() {
+    if (!std::atomic_load(&m_pending)) return nullptr;
+    return std::atomic_exchange(&m_pending, std::shared_ptr<ResultSnapshot>());
+}
+
+RowUpdates::RowUpdates(size_t shardCount) {
+    if (shardCount == 0) shardCount = 1;
+    for (size_t i = 0; i < shardCount; ++i) {
+        m_shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+void RowUpdates::post(const Movie& movie) {
+    Shard& shard = *m_shards[std::hash<std::string>()(movie.imdb_id) % m_shards.size()];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.movies[movie.imdb_id] = movie;
+    m_pending = true;   // after the insert, so a drain that clears the flag first still sees it
+}
+
+bool RowUpdates::drain(std::vector<Movie>& out) {
+    if (!m_pending.exchange(false)) return false;
+
+    for (auto& shard : m_shards) {
+        std::unordered_map<std::string, Movie> movies;
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            movies.swap(shard->movies);
+        }
+        for (auto& entry : movies) {
+            out.push_back(std::move(entry.second));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "movie.h"
+#include "movie_table.h"
+
+// A complete result list built off the UI thread
+struct ResultSnapshot {
+    uint64_t generation = 0;    // query the list belongs to
+    MovieTable table;
+};
+
+// Latest-wins hand-off of result lists to the UI thread. Workers publish a
+// finished snapshot, the UI takes it once per frame without waiting on any
+// lock the workers hold. An unclaimed snapshot is replaced by a newer one,
+// never by one of an older generation.
+class ResultMailbox {
+public:
+    void publish(std::shared_ptr<ResultSnapshot> snapshot);
+    std::shared_ptr<ResultSnapshot> take();     // null when nothing new arrived
+
+private:
+    std::shared_ptr<ResultSnapshot> m_pending;  // accessed through std::atomic_* only
+};
+
+// Per-row changes (details, end of a fetch) keyed by imdb_id, posted by
+// workers and applied by the UI thread to its own table. Lock striped like
+// MovieCache, and drain() skips the locks while nothing is pending.
+class RowUpdates {
+public:
+    explicit RowUpdates(size_t shardCount = 8);
+
+    void post(const Movie& movie);          // a newer update of the same movie replaces the older
+    bool drain(std::vector<Movie>& out);    // appends and clears, false when nothing was pending
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Movie> movies;
+    };
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::atomic<bool> m_pending{ false };
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Coalesces concurrent requests for the same key. The first caller becomes
+// the leader and starts the work, later callers only attach their callback.
+// complete() hands the one result to everybody and forgets the key. The
+// leader has to call it on every path, a failure included, or later joins
+// for the key wait forever.
+template <typename Result>
+class SingleFlight {
+public:
+    using Callback = std::function<void(const Result&)>;
+
+    // Returns true when the caller is the leader and has to start the work
+    bool join(const std::string& key, Callback callback) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_waiters.find(key);
+        if (it != m_waiters.end()) {
+            it->second.push_back(std::move(callback));
+            ++m_coalesced;
+            return false;
+        }
+        m_waiters[key].push_back(std::move(callback));
+        return true;
+    }
+
+    void complete(const std::string& key, const Result& result) {
+        std::vector<Callback> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_waiters.find(key);
+            if (it == m_waiters.end()) return;
+            callbacks = std::move(it->second);
+            m_waiters.erase(it);
+        }
+
+        for (auto& callback : callbacks) {      // outside the lock, callbacks may join again
+            if (callback) callback(result);
+        }
+    }
+
+    bool isInFlight(const std::string& key) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_waiters.count(key) != 0;
+    }
+
+    size_t inFlightCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_waiters.size();
+    }
+
+    uint64_t coalescedCount() const { return m_coalesced; }
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::vector<Callback>> m_waiters;
+    std::atomic<uint64_t> m_coalesced{ 0 };
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded single-producer single-consumer ring. push() and pop() take no
+// lock, each index is written by one side only and the other side reads
+// it once per wrap through a cached copy.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : m_slots(roundUp(capacity)), m_mask(m_slots.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer thread only, false when full
+    bool push(T value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache == m_slots.size()) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache == m_slots.size()) return false;
+        }
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only, false when empty
+    bool pop(T& out) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) return false;
+        }
+        out = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        return size;
+    }
+
+    std::vector<T> m_slots;
+    const size_t m_mask;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> m_head{ 0 };
+    size_t m_tailCache = 0;     // consumer's copy of m_tail
+    alignas(64) std::atomic<size_t> m_tail{ 0 };
+    size_t m_headCache = 0;     // producer's copy of m_head
+};
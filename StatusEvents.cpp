@@ -0,0 +1,163 @@
+#include "StatusEvents.h"
+#include <algorithm>
+
+namespace {
+
+uint64_t nextChannelId() {
+    static std::atomic<uint64_t> counter{ 1 };
+    return counter++;
+}
+
+}
+
+const char* statusKindName(StatusKind kind) {
+    switch (kind) {
+    case StatusKind::Searching: return "Searching";
+    case StatusKind::LocalMatches: return "Local matches";
+    case StatusKind::SearchDone: return "Search";
+    case StatusKind::NoResults: return "No results";
+    case StatusKind::SearchFailed: return "Search failed";
+    case StatusKind::Throttled: return "Throttled";
+    case StatusKind::EmptyQuery: return "Empty query";
+    case StatusKind::SearchStopped: return "Search stopped";
+    case StatusKind::FavoritesLoading: return "Loading favorites";
+    case StatusKind::FavoritesLoaded: return "Favorites";
+    case StatusKind::FavoriteAdded: return "Favorite added";
+    case StatusKind::FavoriteRemoved: return "Favorite removed";
+    case StatusKind::DetailsLoaded: return "Details";
+    case StatusKind::DetailsFailed: return "Details failed";
+    case StatusKind::DetailsPrefetched: return "Prefetch";
+    default: return "";
+    }
+}
+
+StatusTone statusTone(StatusKind kind) {
+    switch (kind) {
+    case StatusKind::Searching:
+    case StatusKind::LocalMatches:
+    case StatusKind::FavoritesLoading:
+        return StatusTone::Busy;
+    case StatusKind::SearchDone:
+    case StatusKind::FavoritesLoaded:
+    case StatusKind::DetailsLoaded:
+    case StatusKind::DetailsPrefetched:
+        return StatusTone::Done;
+    case StatusKind::FavoriteAdded:
+    case StatusKind::FavoriteRemoved:
+        return StatusTone::Info;
+    default:
+        return StatusTone::Error;
+    }
+}
+
+bool isProgress(StatusKind kind) {
+    return statusTone(kind) == StatusTone::Busy;
+}
+
+bool isStatusLine(StatusKind kind) {
+    return kind != StatusKind::DetailsLoaded && kind != StatusKind::DetailsFailed && kind != StatusKind::DetailsPrefetched;
+}
+
+std::string describe(const StatusEvent& event) {
+    std::string count = std::to_string(event.count);
+    switch (event.kind) {
+    case StatusKind::Searching: return event.count == 0 ? "Searching..." : "Searching... (" + count + " found)";
+    case StatusKind::LocalMatches: return "Searching... (" + count + " found locally)";
+    case StatusKind::SearchDone: return "Found " + count + " results";
+    case StatusKind::NoResults: return "No results found";
+    case StatusKind::SearchFailed: return "Request failed!";
+    case StatusKind::Throttled: return "Request limit reached, try again later";
+    case StatusKind::EmptyQuery: return "Empty search query";
+    case StatusKind::SearchStopped: return "Search stopped";
+    case StatusKind::FavoritesLoading: return "Loading favorites...";
+    case StatusKind::FavoritesLoaded: return "Loaded " + count + " favorite movies";
+    case StatusKind::FavoriteAdded: return "Added to favorites";
+    case StatusKind::FavoriteRemoved: return "Removed from favorites";
+    case StatusKind::DetailsLoaded: return "Details loaded";
+    case StatusKind::DetailsFailed: return "Details unavailable";
+    case StatusKind::DetailsPrefetched: return "Details prefetched";
+    default: return "";
+    }
+}
+
+// ---------------------------------------------------------------- StatusChannel
+
+StatusChannel::StatusChannel() : m_id(nextChannelId()) {}
+
+StatusChannel::~StatusChannel() {
+    size_t count = m_producerCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        m_producers[i]->closed = true;
+    }
+}
+
+StatusChannel::ThreadProducers::~ThreadProducers() {
+    for (auto& entry : producers) {
+        entry.second->owned.store(false, std::memory_order_release);   // after this thread's last push
+    }
+}
+
+StatusChannel::Producer* StatusChannel::producer() {
+    thread_local ThreadProducers threadProducers;
+    auto& producers = threadProducers.producers;
+    for (const auto& entry : producers) {
+        if (entry.first == m_id) return entry.second.get();
+    }
+
+    // First push from this thread, forget the queues of channels that are gone
+    producers.erase(std::remove_if(producers.begin(), producers.end(),
+        [](const auto& entry) { return entry.second->closed.load(); }), producers.end());
+
+    std::lock_guard<std::mutex> lock(m_registerMutex);
+    size_t count = m_producerCount.load(std::memory_order_relaxed);
+    std::shared_ptr<Producer> found;
+    for (size_t i = 0; i < count && !found; ++i) {
+        if (!m_producers[i]->owned.load(std::memory_order_acquire)) {
+            found = m_producers[i];     // the queue of a finished thread, still drained in the same slot
+            found->owned = true;
+        }
+    }
+    if (!found) {
+        if (count == kMaxProducers) return nullptr;
+        found = std::make_shared<Producer>();
+        m_producers[count] = found;
+        m_producerCount.store(count + 1, std::memory_order_release);    // the consumer sees the queue before the count
+    }
+    producers.emplace_back(m_id, found);
+    return found.get();
+}
+
+bool StatusChannel::push(StatusEvent event) {
+    event.time = StatusEvent::Clock::now();
+    Producer* target = producer();
+    if (!target || !target->queue.push(std::move(event))) {
+        ++m_dropped;
+        return false;
+    }
+    return true;
+}
+
+size_t StatusChannel::drain(std::vector<StatusEvent>& out) {
+    size_t first = out.size();
+    size_t producerCount = m_producerCount.load(std::memory_order_acquire);
+    StatusEvent event;
+    for (size_t i = 0; i < producerCount; ++i) {
+        while (m_producers[i]->queue.pop(event)) {
+            out.push_back(std::move(event));
+        }
+    }
+
+    // Each queue is in order already, only the sources interleave
+    std::stable_sort(out.begin() + first, out.end(),
+        [](const StatusEvent& a, const StatusEvent& b) { return a.time < b.time; });
+    return out.size() - first;
+}
+
+// ---------------------------------------------------------------- StatusLog
+
+void StatusLog::add(const StatusEvent& event) {
+    if (isProgress(event.kind) || event.kind == StatusKind::None) return;
+
+    if (m_entries.size() == m_capacity) m_entries.pop_front();
+    m_entries.push_back(Entry{ event.time, event.kind, event.latency, describe(event), event.text });
+}
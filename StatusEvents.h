@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "SpscQueue.h"
+
+enum class StatusKind : uint8_t
+{
+    None,
+    // Status line, count is the number of results
+    Searching,
+    LocalMatches,       // seen before, shown while the api is asked
+    SearchDone,
+    NoResults,
+    SearchFailed,
+    Throttled,          // daily quota or rate limit spent
+    EmptyQuery,
+    SearchStopped,
+    FavoritesLoading,
+    FavoritesLoaded,
+    FavoriteAdded,
+    FavoriteRemoved,
+    // Log only
+    DetailsLoaded,
+    DetailsFailed,
+    DetailsPrefetched,
+    Count
+};
+
+enum class StatusTone { Busy, Done, Info, Error };
+
+struct StatusEvent {
+    using Clock = std::chrono::steady_clock;
+
+    StatusKind kind = StatusKind::None;
+    uint64_t generation = 0;        // search the event belongs to, 0 = not tied to one
+    size_t count = 0;
+    std::string text;               // query or title the event is about
+    Clock::time_point time;         // set by StatusChannel::push
+    Clock::duration latency{ 0 };   // since the operation started, zero when not measured
+};
+
+const char* statusKindName(StatusKind kind);
+StatusTone statusTone(StatusKind kind);
+bool isProgress(StatusKind kind);           // replaced by the next event, not logged
+bool isStatusLine(StatusKind kind);         // false for the log only kinds
+std::string describe(const StatusEvent& event);     // "Found 12 results"
+
+// Status events from worker threads to the UI. Every producer thread gets
+// its own SpscQueue on its first push (one short lock), after that pushes
+// are lock free. A queue outlives its thread and is handed to the next new
+// producer, so short lived threads don't use up the slots. The UI drains
+// all queues once per frame, merged by time. A full queue drops the event
+// and counts it, a producer never waits.
+class StatusChannel {
+public:
+    static constexpr size_t kMaxProducers = 64;
+    static constexpr size_t kQueueCapacity = 256;
+
+    StatusChannel();
+    ~StatusChannel();
+
+    StatusChannel(const StatusChannel&) = delete;
+    StatusChannel& operator=(const StatusChannel&) = delete;
+
+    bool push(StatusEvent event);       // any thread, stamps event.time
+    size_t drain(std::vector<StatusEvent>& out);    // one consumer thread, appends in time order
+    uint64_t dropped() const { return m_dropped; }
+
+private:
+    struct Producer {
+        Producer() : queue(kQueueCapacity) {}
+
+        SpscQueue<StatusEvent> queue;
+        std::atomic<bool> owned{ true };    // cleared when the producing thread exits
+        std::atomic<bool> closed{ false };  // the channel is gone
+    };
+
+    // The calling thread's queues, one per channel it pushed to
+    struct ThreadProducers {
+        ~ThreadProducers();
+        std::vector<std::pair<uint64_t, std::shared_ptr<Producer>>> producers;
+    };
+
+    Producer* producer();
+
+    const uint64_t m_id;    // per-thread lookups key on this, not on the address
+    std::mutex m_registerMutex;
+    std::shared_ptr<Producer> m_producers[kMaxProducers];
+    std::atomic<size_t> m_producerCount{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+};
+
+// The last operations with their latencies, for the in-app log. UI thread only.
+class StatusLog {
+public:
+    struct Entry {
+        StatusEvent::Clock::time_point time;
+        StatusKind kind;
+        StatusEvent::Clock::duration latency;
+        std::string message;
+        std::string text;
+    };
+
+    explicit StatusLog(size_t capacity = 200) : m_capacity(capacity) {}
+
+    void add(const StatusEvent& event);     // progress events are skipped
+    void clear() { m_entries.clear(); }
+
+    size_t size() const { return m_entries.size(); }
+    const Entry& at(size_t index) const { return m_entries[index]; }   // 0 = oldest
+
+private:
+    size_t m_capacity;
+    std::deque<Entry> m_entries;
+};
@@ -0,0 +1,115 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <iostream>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        // The work is mostly network bound, keep a small flat number of threads
+        size_t hw = std::thread::hardware_concurrency();
+        threadCount = std::min<size_t>(std::max<size_t>(hw, 2), 8);
+    }
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+bool ThreadPool::submit(std::function<void()> task, TaskPriority priority, CancellationToken token) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping || token.isCancelled()) return false;
+        m_tasks.push(Task{ std::move(task), priority, m_nextSequence++, std::move(token) });
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+bool ThreadPool::submitAfter(Clock::duration delay, std::function<void()> task, TaskPriority priority,
+    CancellationToken token) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping || token.isCancelled()) return false;
+        // The sequence is taken when it becomes due, among the tasks queued by then
+        m_delayed.push(DelayedTask{ Clock::now() + delay, Task{ std::move(task), priority, 0, std::move(token) } });
+    }
+    m_cv.notify_one();      // a sleeping worker may have to wake up earlier
+    return true;
+}
+
+void ThreadPool::shutdown() {
+    // Pending work is dropped, running work finishes. The tasks are destroyed
+    // outside the lock, what they own may still call submit() on the way out
+    std::priority_queue<Task, std::vector<Task>, TaskOrder> tasks;
+    std::priority_queue<DelayedTask, std::vector<DelayedTask>, DueOrder> delayed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) return;
+        m_stopping = true;
+        std::swap(tasks, m_tasks);
+        std::swap(delayed, m_delayed);
+    }
+    m_cv.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+size_t ThreadPool::pendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tasks.size() + m_delayed.size();
+}
+
+size_t ThreadPool::queueDueTasks(Clock::time_point now) {
+    size_t queued = 0;
+    for (; !m_delayed.empty() && m_delayed.top().due <= now; ++queued) {
+        Task task = m_delayed.top().task;
+        m_delayed.pop();
+        task.sequence = m_nextSequence++;
+        m_tasks.push(std::move(task));
+    }
+    return queued;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            size_t queued = 0;
+            while (true) {
+                if (m_stopping) return;
+                queued += queueDueTasks(Clock::now());
+                if (!m_tasks.empty()) break;
+                if (m_delayed.empty()) {
+                    m_cv.wait(lock);
+                }
+                else {
+                    m_cv.wait_until(lock, m_delayed.top().due);
+                }
+            }
+
+            task = m_tasks.top();
+            m_tasks.pop();
+            if (queued > 0 && !m_tasks.empty()) {
+                m_cv.notify_one();  // more became due at once, wake a worker that sleeps without a deadline
+            }
+        }
+
+        if (task.token.isCancelled()) continue;
+
+        try {
+            task.fn();
+        }
+        catch (const std::exception& e) {
+            std::cout << "Background task failed: " << e.what() << std::endl;
+        }
+    }
+}
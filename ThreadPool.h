@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+enum class TaskPriority
+{
+    Low = 0,        // speculative work (prefetch)
+    Normal = 1,     // searches, sorting
+    High = 2        // work the user is waiting on (opened details)
+};
+
+// Shared cancellation flag, cheap to copy into tasks
+class CancellationToken {
+public:
+    CancellationToken() : m_cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { m_cancelled->store(true); }
+    bool isCancelled() const { return m_cancelled->load(); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+// Fixed size worker pool with a priority queue.
+// Tasks of equal priority run in submit order, cancelled tasks are skipped.
+// Delayed tasks join the queue when they are due, so a task that has to
+// wait (e.g. for the rate limiter) gives its worker back meanwhile.
+class ThreadPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ThreadPool(size_t threadCount = 0);   // 0 = pick from hardware_concurrency
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    bool submit(std::function<void()> task,
+        TaskPriority priority = TaskPriority::Normal,
+        CancellationToken token = CancellationToken());
+    bool submitAfter(Clock::duration delay, std::function<void()> task,
+        TaskPriority priority = TaskPriority::Normal,
+        CancellationToken token = CancellationToken());
+
+    void shutdown();    // drop pending and delayed tasks and join the workers
+
+    size_t threadCount() const { return m_workers.size(); }
+    size_t pendingCount() const;    // queued and delayed
+
+private:
+    struct Task {
+        std::function<void()> fn;
+        TaskPriority priority;
+        uint64_t sequence;
+        CancellationToken token;
+    };
+
+    struct TaskOrder {
+        bool operator()(const Task& a, const Task& b) const {
+            if (a.priority != b.priority) return a.priority < b.priority;
+            return a.sequence > b.sequence;     // FIFO inside the same priority
+        }
+    };
+
+    struct DelayedTask {
+        Clock::time_point due;
+        Task task;
+    };
+
+    struct DueOrder {
+        bool operator()(const DelayedTask& a, const DelayedTask& b) const { return a.due > b.due; }
+    };
+
+    void workerLoop();
+    size_t queueDueTasks(Clock::time_point now);    // call with m_mutex held, returns how many
+
+    std::vector<std::thread> m_workers;
+    std::priority_queue<Task, std::vector<Task>, TaskOrder> m_tasks;
+    std::priority_queue<DelayedTask, std::vector<DelayedTask>, DueOrder> m_delayed;     // earliest due first
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    uint64_t m_nextSequence = 0;
+    bool m_stopping = false;
+};
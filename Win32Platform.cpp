@@ -0,0 +1,6 @@
+#include "Win32Platform.h"
+#include <windows.h>
+
+void Win32Platform::openUrl(const std::string& url) {
+    ShellExecuteA(NULL, "open", url.c_str(), NULL, NULL, SW_SHOWNORMAL);
+}
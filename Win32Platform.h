@@ -0,0 +1,17 @@
+#pragma once
+#include "PlatformServices.h"
+#include "FrameScheduler.h"
+
+// Opens urls in the default browser through ShellExecute, frame requests
+// go to the window's FrameScheduler
+class Win32Platform : public PlatformServices {
+public:
+    explicit Win32Platform(FrameScheduler& frames) : m_frames(frames) {}
+
+    void openUrl(const std::string& url) override;
+    void requestFrame() override { m_frames.requestFrame(); }
+    void requestFrameAfter(double seconds) override { m_frames.requestFrameAfter(seconds); }
+
+private:
+    FrameScheduler& m_frames;
+};
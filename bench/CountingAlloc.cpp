@@ -0,0 +1,19 @@
+// Replacement global operator new/delete that feed the bench counters.
+// Kept in its own translation unit so the frees are never inlined next to
+// the library's operator new calls.
+
+#include "bench.h"
+#include <cstdlib>
+#include <new>
+
+void* operator new(std::size_t size) {
+    g_allocatedBytes += size;
+    ++g_allocationCount;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,96 @@
+#include "StubOmdbServer.h"
+#include <httplib.h>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+    const char* kGenres[] = { "Action, Adventure", "Drama", "Comedy, Romance", "Horror, Thriller", "Animation, Family" };
+
+    std::string imdbIdFor(size_t index) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "tt%07zu", index);
+        return buf;
+    }
+}
+
+StubOmdbServer::StubOmdbServer(size_t totalResults)
+    : m_server(std::make_unique<httplib::Server>()), m_totalResults(totalResults) {
+    m_server->set_tcp_nodelay(true);
+
+    m_server->Get("/", [this](const httplib::Request& req, httplib::Response& res) {
+        ++m_requests;
+        if (req.has_param("i")) {
+            res.set_content(detailsBody(req.get_param_value("i")), "application/json");
+        }
+        else if (req.has_param("s")) {
+            size_t page = req.has_param("page") ? std::stoul(req.get_param_value("page")) : 1;
+            res.set_content(searchBody(req.get_param_value("s"), page, m_totalResults), "application/json");
+        }
+        else {
+            res.set_content(R"({"Response":"False","Error":"Incorrect IMDb ID."})", "application/json");
+        }
+        });
+}
+
+StubOmdbServer::~StubOmdbServer() {
+    stop();
+}
+
+bool StubOmdbServer::start() {
+    m_port = m_server->bind_to_any_port("127.0.0.1");
+    if (m_port <= 0) return false;
+
+    m_thread = std::thread([this]() { m_server->listen_after_bind(); });
+    m_server->wait_until_ready();
+    return true;
+}
+
+void StubOmdbServer::stop() {
+    if (m_thread.joinable()) {
+        m_server->stop();
+        m_thread.join();
+    }
+}
+
+std::string StubOmdbServer::searchBody(const std::string& query, size_t page, size_t totalResults) {
+    size_t first = (page - 1) * 10;
+    if (page == 0 || first >= totalResults) {
+        return R"({"Response":"False","Error":"Movie not found!"})";
+    }
+
+    json hits = json::array();
+    for (size_t i = first; i < std::min(first + 10, totalResults); ++i) {
+        hits.push_back({
+            {"Title", query + " " + std::to_string(i)},
+            {"Year", std::to_string(1950 + i % 75)},
+            {"imdbID", imdbIdFor(i)},
+            {"Type", i % 7 == 0 ? "series" : "movie"},
+            {"Poster", "https://m.media-amazon.com/images/M/" + imdbIdFor(i) + "._V1_SX300.jpg"}
+            });
+    }
+    json body = { {"Search", hits}, {"totalResults", std::to_string(totalResults)}, {"Response", "True"} };
+    return body.dump();
+}
+
+std::string StubOmdbServer::detailsBody(const std::string& imdbId) {
+    size_t index = imdbId.size() > 2 ? std::strtoul(imdbId.c_str() + 2, nullptr, 10) : 0;
+    json body = {
+        {"Title", "Movie " + std::to_string(index)},
+        {"Year", std::to_string(1950 + index % 75)},
+        {"Rated", "PG-13"},
+        {"Released", std::to_string(10 + index % 18) + " Mar " + std::to_string(1950 + index % 75)},
+        {"Runtime", std::to_string(80 + index % 90) + " min"},
+        {"Genre", kGenres[index % 5]},
+        {"Director", "Director " + std::to_string(index % 300)},
+        {"Actors", "Actor " + std::to_string(index % 1000) + ", Actor " + std::to_string((index * 7) % 1000)},
+        {"Plot", "A long plot summary for movie " + std::to_string(index) +
+            ", padded to look like a real full plot text from the api. " + std::string(400, 'x')},
+        {"imdbRating", index % 11 == 0 ? "N/A" : std::to_string(1 + index % 9) + "." + std::to_string(index % 10)},
+        {"imdbID", imdbId},
+        {"Type", "movie"},
+        {"Poster", "https://m.media-amazon.com/images/M/" + imdbId + "._V1_SX300.jpg"},
+        {"Response", "True"}
+    };
+    return body.dump();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace httplib { class Server; }
+
+// Local stand-in for www.omdbapi.com. Answers "s=" searches with
+// deterministic pages of 10 hits and "i=" lookups with full details,
+// so the network paths can be measured without the real api.
+class StubOmdbServer {
+public:
+    explicit StubOmdbServer(size_t totalResults = 100);
+    ~StubOmdbServer();
+
+    bool start();   // binds a free port on 127.0.0.1
+    void stop();
+
+    int port() const { return m_port; }
+    uint64_t requestCount() const { return m_requests; }
+
+    // Bodies the stub serves, also used by the parse benchmarks
+    static std::string searchBody(const std::string& query, size_t page, size_t totalResults);
+    static std::string detailsBody(const std::string& imdbId);
+
+private:
+    std::unique_ptr<httplib::Server> m_server;
+    std::thread m_thread;
+    size_t m_totalResults;
+    int m_port = 0;
+    std::atomic<uint64_t> m_requests{ 0 };
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Heap traffic through operator new, counted by CountingAlloc.cpp
+inline std::atomic<uint64_t> g_allocatedBytes{ 0 };
+inline std::atomic<uint64_t> g_allocationCount{ 0 };
+
+// Minimal timing harness. Every result is one JSON object per line on
+// stdout, so runs can be diffed or collected by a script.
+class Bench {
+public:
+    Bench(double minSeconds, const std::string& filter) : m_minSeconds(minSeconds), m_filter(filter) {}
+
+    bool enabled(const std::string& name) const {
+        return m_filter.empty() || name.find(m_filter) != std::string::npos;
+    }
+
+    // Runs fn until minSeconds have passed (at least once). fn does
+    // batch operations per call, results are reported per operation.
+    template <typename Fn>
+    void run(const std::string& name, size_t n, Fn fn, size_t batch = 1) {
+        if (!enabled(name)) return;
+
+        using Clock = std::chrono::steady_clock;
+        uint64_t iterations = 0;
+        double total = 0.0;
+        double best = 0.0;
+        uint64_t allocatedBefore = g_allocatedBytes;
+        do {
+            auto start = Clock::now();
+            fn();
+            double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            total += elapsed;
+            best = iterations == 0 ? elapsed : std::min(best, elapsed);
+            ++iterations;
+        } while (total < m_minSeconds * 1e9);
+
+        double perOp = total / (static_cast<double>(iterations) * batch);
+        double allocatedPerOp = static_cast<double>(g_allocatedBytes - allocatedBefore) / (static_cast<double>(iterations) * batch);
+        std::printf("{\"name\":\"%s\",\"n\":%zu,\"iterations\":%llu,\"ns_per_op\":%.1f,\"min_ns_per_op\":%.1f,\"ops_per_sec\":%.1f,\"alloc_bytes_per_op\":%.1f}\n",
+            name.c_str(), n, static_cast<unsigned long long>(iterations), perOp, best / batch,
+            perOp > 0.0 ? 1e9 / perOp : 0.0, allocatedPerOp);
+        std::fflush(stdout);
+    }
+
+private:
+    double m_minSeconds;
+    std::string m_filter;
+};
@@ -0,0 +1,227 @@
+// Frame time benchmarks for MovieSearchApp::render without a window.
+// Drives ImGui::NewFrame/Render with synthetic ImGuiIO input, a null
+// renderer only walks the ImDrawData. Builds on Linux, see CMakeLists.txt.
+//
+//   movie_frame_bench [--quick] [--filter <substring>]
+//
+// Prints one JSON object per scenario: frame CPU time percentiles, draw
+// data sizes and heap allocations per frame.
+
+#include "bench.h"
+#include "../movie_search_app.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int kWarmupFrames = 3;    // the list arrives and is sorted first, reported on their own
+
+// Records the urls instead of opening them
+class NullPlatform : public PlatformServices {
+public:
+    void openUrl(const std::string&) override { ++opened; }
+    size_t opened = 0;
+};
+
+// Full details, so nothing is fetched or prefetched. Zero padded titles keep
+// the title order equal to the generation order
+std::vector<Movie> makeMovies(size_t count) {
+    static const char* genres[] = { "Drama", "Action, Adventure", "Comedy", "Crime, Drama, Thriller", "Animation" };
+    std::vector<Movie> movies(count);
+    char buffer[64];
+    for (size_t i = 0; i < count; ++i) {
+        Movie& movie = movies[i];
+        std::snprintf(buffer, sizeof(buffer), "Movie %07zu", i);
+        movie.title = buffer;
+        movie.year = std::to_string(1950 + i % 75);
+        std::snprintf(buffer, sizeof(buffer), "tt%07zu", i);
+        movie.imdb_id = buffer;
+        movie.type = i % 7 == 0 ? "series" : "movie";
+        movie.poster_url = "https://m.media-amazon.com/images/M/" + movie.imdb_id + "._V1_SX300.jpg";
+        movie.plot = "A long synthetic plot for row " + std::to_string(i) + ", wrapped over a few lines in the expanded view of the header.";
+        movie.rating = std::to_string(1 + i % 9) + "." + std::to_string(i % 10);
+        movie.director = "Director " + std::to_string(i % 300);
+        movie.actors = "Actor " + std::to_string(i % 500) + ", Actor " + std::to_string((i + 7) % 500);
+        movie.genre = genres[i % 5];
+        movie.runtime = std::to_string(80 + i % 90) + " min";
+        movie.released = std::to_string(10 + i % 18) + " Mar " + movie.year;
+        movie.hasDetails = true;
+    }
+    return movies;
+}
+
+struct FrameSample {
+    double us;
+    int vertices;
+    int indices;
+    int commands;
+    uint64_t allocations;
+    uint64_t allocatedBytes;
+};
+
+// Stands in for a GPU backend: touches every command so the draw data is really consumed
+int consumeDrawData(const ImDrawData* drawData, int& commands) {
+    int checksum = 0;
+    commands = 0;
+    for (const ImDrawList* list : drawData->CmdLists) {
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            checksum += static_cast<int>(cmd.ElemCount) + static_cast<int>(cmd.ClipRect.x);
+            ++commands;
+        }
+        if (!list->VtxBuffer.empty()) checksum += static_cast<int>(list->VtxBuffer[0].pos.x);
+    }
+    return checksum;
+}
+
+// ImGui allocates through malloc/free by default, route it through the same counters
+void* countingAlloc(size_t size, void*) {
+    g_allocatedBytes += size;
+    ++g_allocationCount;
+    return std::malloc(size);
+}
+void countingFree(void* p, void*) { std::free(p); }
+
+using Script = std::function<void(int frame, MovieSearchApp& app, ImGuiIO& io)>;
+
+void runScenario(const std::string& name, size_t n, int frames, const Script& script, const std::string& filter) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+    ImGui::SetAllocatorFunctions(countingAlloc, countingFree);
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    io.Fonts->SetTexID(static_cast<ImTextureID>(1));
+
+    std::vector<FrameSample> samples;
+    double warmupMax = 0.0;
+    int checksum = 0;
+    {
+        NullPlatform platform;
+        MovieSearchApp app(platform);
+        app.showResults(makeMovies(n));
+
+        for (int frame = 0; frame < kWarmupFrames + frames; ++frame) {
+            io.DeltaTime = 1.0f / 60.0f;
+            script(frame - kWarmupFrames, app, io);
+
+            uint64_t allocationsBefore = g_allocationCount;
+            uint64_t bytesBefore = g_allocatedBytes;
+            auto start = Clock::now();
+
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));   // the app sizes its window, the mouse positions rely on this
+            app.render();
+            ImGui::Render();
+            FrameSample sample{};
+            checksum += consumeDrawData(ImGui::GetDrawData(), sample.commands);
+
+            sample.us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            sample.vertices = ImGui::GetDrawData()->TotalVtxCount;
+            sample.indices = ImGui::GetDrawData()->TotalIdxCount;
+            sample.allocations = g_allocationCount - allocationsBefore;
+            sample.allocatedBytes = g_allocatedBytes - bytesBefore;
+            if (frame < kWarmupFrames) warmupMax = std::max(warmupMax, sample.us);
+            else samples.push_back(sample);
+        }
+    }
+    ImGui::DestroyContext();
+
+    std::vector<double> times;
+    double vertices = 0, indices = 0, commands = 0, allocations = 0, bytes = 0;
+    for (const auto& sample : samples) {
+        times.push_back(sample.us);
+        vertices += sample.vertices;
+        indices += sample.indices;
+        commands += sample.commands;
+        allocations += static_cast<double>(sample.allocations);
+        bytes += static_cast<double>(sample.allocatedBytes);
+    }
+    std::sort(times.begin(), times.end());
+    auto at = [&times](double q) { return times[std::min(times.size() - 1, static_cast<size_t>(q * times.size()))]; };
+    double count = static_cast<double>(samples.size());
+
+    std::printf("{\"name\":\"%s\",\"n\":%zu,\"frames\":%zu,\"p50_us\":%.1f,\"p95_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f,"
+        "\"warmup_max_us\":%.1f,\"vertices\":%.0f,\"indices\":%.0f,\"draw_cmds\":%.1f,\"allocs_per_frame\":%.1f,\"alloc_bytes_per_frame\":%.1f,\"checksum\":%d}\n",
+        name.c_str(), n, samples.size(), at(0.5), at(0.95), at(0.99), times.back(), warmupMax,
+        vertices / count, indices / count, commands / count, allocations / count, bytes / count, checksum & 1);
+    std::fflush(stdout);
+}
+
+// Mouse over the results pane, which fills the lower part of the window
+void pointAtResults(ImGuiIO& io) {
+    io.AddMousePosEvent(400.0f, 450.0f);
+}
+
+}
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") quick = true;
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else {
+            std::cerr << "usage: movie_frame_bench [--quick] [--filter <substring>]" << std::endl;
+            return 2;
+        }
+    }
+
+    // The app keeps its caches and favorites next to the working directory
+    fs::path previous = fs::current_path();
+    fs::path dir = fs::temp_directory_path() / "movie_frame_bench";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::current_path(dir);
+
+    const int frames = quick ? 60 : 600;
+    std::vector<size_t> sizes = quick ? std::vector<size_t>{ 10, 10000 } : std::vector<size_t>{ 10, 10000, 100000 };
+
+    for (size_t n : sizes) {
+        runScenario("idle/" + std::to_string(n), n, frames / 4, [](int, MovieSearchApp&, ImGuiIO&) {}, filter);
+
+        // Three wheel notches a frame through the list
+        runScenario("scroll/" + std::to_string(n), n, frames, [](int frame, MovieSearchApp&, ImGuiIO& io) {
+            pointAtResults(io);
+            if (frame >= 0) io.AddMouseWheelEvent(0.0f, -3.0f);
+            }, filter);
+    }
+
+    // The first 100 headers open, then scrolled through one notch a frame
+    runScenario("expand_100/10000", 10000, frames, [](int frame, MovieSearchApp& app, ImGuiIO& io) {
+        pointAtResults(io);
+        if (frame == -1) {
+            char id[32];
+            for (int i = 0; i < 100; ++i) {
+                std::snprintf(id, sizeof(id), "tt%07d", i);
+                app.setExpanded(id, true);
+            }
+        }
+        if (frame >= 0) io.AddMouseWheelEvent(0.0f, -1.0f);
+        }, filter);
+
+    // A different sort every 10 frames, the first use of each key builds its index
+    runScenario("toggle_sort/10000", 10000, frames / 2, [](int frame, MovieSearchApp& app, ImGuiIO&) {
+        if (frame < 0 || frame % 10 != 0) return;
+        int step = frame / 10;
+        int count = static_cast<int>(SortCriteria::Count);
+        app.setSort(static_cast<SortCriteria>(step % count), (step / count) % 2 == 0);
+        }, filter);
+
+    fs::current_path(previous);
+    fs::remove_all(dir);
+    return 0;
+}
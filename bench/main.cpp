@@ -0,0 +1,367 @@
+// Microbenchmarks for the search, parse, sort and favorites hot paths.
+// Builds without the Win32/OpenGL frontend, see CMakeLists.txt.
+//
+//   movie_bench [--quick] [--filter <substring>]
+//
+// Prints one JSON object per result line.
+
+#include "bench.h"
+#include "StubOmdbServer.h"
+#include "../MovieCache.h"
+#include "../MovieFavorites.h"
+#include "../MovieSearchService.h"
+#include "../movie_sort.h"
+#include "../movie_table.h"
+#include "../OmdbParser.h"
+#include "../MovieIndex.h"
+#include "../RateLimiter.h"
+#include <json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Keeps the optimizer from dropping results
+volatile size_t g_sink = 0;
+
+std::vector<Movie> makeMovies(size_t count) {
+    std::vector<Movie> movies;
+    movies.reserve(count);
+    for (size_t page = 1; movies.size() < count; ++page) {
+        OmdbResponse search;
+        std::string body = StubOmdbServer::searchBody("Movie", page, count);
+        parseOmdbResponse(body.data(), body.size(), search);
+
+        for (const auto& hit : search.hits) {
+            OmdbResponse details;
+            body = StubOmdbServer::detailsBody(hit.imdb_id);
+            parseOmdbResponse(body.data(), body.size(), details);
+            Movie movie = details.movie;
+            movie.title = hit.title;
+            movie.hasDetails = true;
+            movies.push_back(movie);
+        }
+    }
+    return movies;
+}
+
+void benchParse(Bench& bench) {
+    std::string page = StubOmdbServer::searchBody("Matrix", 1, 100);
+    std::string details = StubOmdbServer::detailsBody("tt0133093");
+
+    // The old path: a json DOM first, then the fields copied out of it
+    bench.run("parse/search_page_dom", 10, [&]() {
+        json j = json::parse(page);
+        std::vector<Movie> movies;
+        for (const auto& item : j["Search"]) {
+            Movie movie;
+            movie.title = item.value("Title", "Unknown Title");
+            movie.year = item.value("Year", "N/A");
+            movie.imdb_id = item.value("imdbID", "");
+            movie.poster_url = item.value("Poster", "N/A");
+            movie.type = item.value("Type", "unknown");
+            movies.push_back(movie);
+        }
+        g_sink += movies.size();
+        });
+
+    OmdbResponse response;
+    bench.run("parse/search_page_sax", 10, [&]() {
+        parseOmdbResponse(page.data(), page.size(), response);
+        g_sink += response.hits.size();
+        });
+
+    bench.run("parse/details_dom", 1, [&]() {
+        json j = json::parse(details);
+        Movie movie;
+        movie.plot = j.value("Plot", "N/A");
+        movie.rating = j.value("imdbRating", "N/A");
+        movie.actors = j.value("Actors", "N/A");
+        movie.director = j.value("Director", "N/A");
+        movie.genre = j.value("Genre", "N/A");
+        movie.runtime = j.value("Runtime", "N/A");
+        movie.released = j.value("Released", "N/A");
+        g_sink += movie.plot.size();
+        });
+
+    bench.run("parse/details_sax", 1, [&]() {
+        parseOmdbResponse(details.data(), details.size(), response);
+        g_sink += response.movie.plot.size();
+        });
+}
+
+void benchSort(Bench& bench, const std::vector<size_t>& sizes) {
+    for (size_t n : sizes) {
+        MovieTable table;
+        table.assign(makeMovies(n));
+
+        for (int c = 0; c < static_cast<int>(SortCriteria::Count); ++c) {
+            SortCriteria criteria = static_cast<SortCriteria>(c);
+            std::string name = std::string("sort/") + sortCriteriaName(criteria);
+            std::vector<SortKey> up = { SortKey{ criteria, true } };
+            std::vector<SortKey> down = { SortKey{ criteria, false } };
+
+            MovieSortIndex index;
+            bench.run(name + "/build", n, [&]() {
+                index.clear();
+                g_sink += index.order(table, up)[0];
+                });
+
+            // Direction flips and re-renders reuse the cached index
+            bench.run(name + "/reverse_cached", n, [&]() {
+                g_sink += index.order(table, down)[0] + index.order(table, up)[0];
+                });
+        }
+
+        MovieSortIndex index;
+        std::vector<SortKey> keys = { SortKey{ SortCriteria::Year, false }, SortKey{ SortCriteria::Title, true } };
+        bench.run("sort/Year+Title/build", n, [&]() {
+            index.clear();
+            g_sink += index.order(table, keys)[0];
+            });
+    }
+}
+
+void benchFavorites(Bench& bench, const std::vector<size_t>& sizes, const fs::path& dir) {
+    for (size_t n : sizes) {
+        std::vector<Movie> movies = makeMovies(n);
+        std::string file = (dir / ("favorites_" + std::to_string(n) + ".json")).string();
+
+        json j = json::array();
+        for (const auto& movie : movies) {
+            j.push_back({ {"title", movie.title}, {"year", movie.year}, {"imdb_id", movie.imdb_id},
+                {"poster_url", movie.poster_url}, {"type", movie.type}, {"plot", movie.plot},
+                {"rating", movie.rating}, {"actors", movie.actors}, {"director", movie.director},
+                {"genre", movie.genre}, {"runtime", movie.runtime}, {"released", movie.released},
+                {"hasDetails", movie.hasDetails} });
+        }
+        std::ofstream(file) << j.dump(4);
+
+        MovieFavorites favorites(file);
+        favorites.setFlushWindow(std::chrono::milliseconds(0));     // the writes are timed, not the coalescing window
+        std::string suffix = "/" + std::to_string(n);
+
+        bench.run("favorites/load" + suffix, n, [&]() {
+            std::promise<size_t> loaded;
+            favorites.loadFavoritesAsync([&loaded](const std::vector<Movie>& result) { loaded.set_value(result.size()); });
+            g_sink += loaded.get_future().get();
+            while (favorites.isLoading()) {     // the flag drops just after the callback
+                std::this_thread::yield();
+            }
+            });
+
+        bench.run("favorites/save" + suffix, n, [&]() {
+            favorites.saveFavoritesAsync();
+            while (favorites.isSaving()) {
+                std::this_thread::yield();
+            }
+            });
+
+        // Same favorites from the mapped binary snapshot
+        std::string binaryJson = (dir / ("favorites_bin_" + std::to_string(n) + ".json")).string();
+        std::string binaryFile = (dir / ("favorites_bin_" + std::to_string(n) + ".bin")).string();
+        FavoritesSnapshot::write(binaryFile, movies);
+        MovieFavorites binaryFavorites(binaryJson, true);
+
+        bench.run("favorites/load_binary" + suffix, n, [&]() {
+            std::promise<size_t> loaded;
+            binaryFavorites.loadFavoritesAsync([&loaded](const std::vector<Movie>& result) { loaded.set_value(result.size()); });
+            g_sink += loaded.get_future().get();
+            while (binaryFavorites.isLoading()) {
+                std::this_thread::yield();
+            }
+            });
+
+        // Only mapping and walking the views, no Movie is built
+        bench.run("favorites/snapshot_scan" + suffix, n, [&]() {
+            FavoritesSnapshot snapshot;
+            snapshot.open(binaryFile);
+            for (size_t i = 0; i < snapshot.size(); ++i) {
+                g_sink += snapshot.at(i).imdb_id.size();
+            }
+            });
+
+        // One journaled change, flushed with a single append and fsync
+        Movie toggled = movies[n / 2];
+        bench.run("favorites/toggle_flush" + suffix, n, [&]() {
+            favorites.toggleFavorite(toggled);
+            while (favorites.isSaving()) {
+                std::this_thread::yield();
+            }
+            });
+
+        // A burst of clicks inside one flush window, written together
+        size_t burst = std::min<size_t>(n, 50);
+        favorites.setFlushWindow(std::chrono::milliseconds(20));
+        bench.run("favorites/toggle_burst" + suffix, n, [&]() {
+            for (size_t i = 0; i < burst * 2; ++i) {
+                favorites.toggleFavorite(movies[i % burst]);
+            }
+            while (favorites.isSaving()) {
+                std::this_thread::yield();
+            }
+            }, burst * 2);
+
+        // Half hits, half misses, spread over the list
+        std::vector<std::string> probes;
+        for (size_t i = 0; i < 256; ++i) {
+            probes.push_back(i % 2 ? movies[(i * 7919) % n].imdb_id : "tt9" + std::to_string(i));
+        }
+        bench.run("favorites/isFavorite" + suffix, n, [&]() {
+            for (const auto& id : probes) {
+                g_sink += favorites.isFavorite(id);
+            }
+            }, probes.size());
+    }
+}
+
+void benchIndex(Bench& bench, const std::vector<size_t>& sizes, const fs::path& dir) {
+    for (size_t n : sizes) {
+        std::vector<Movie> movies = makeMovies(n);
+        std::string suffix = "/" + std::to_string(n);
+        std::string path = (dir / ("index_" + std::to_string(n) + ".bin")).string();
+
+        bench.run("index/build" + suffix, n, [&]() {
+            MovieIndex index(path);
+            for (const auto& movie : movies) {
+                index.add(movie);
+            }
+            g_sink += index.termCount();
+            });
+
+        MovieIndex index(path);
+        for (const auto& movie : movies) {
+            index.add(movie);
+        }
+        index.save();
+        std::printf("{\"name\":\"index/size%s\",\"n\":%zu,\"terms\":%zu,\"posting_bytes\":%zu,\"file_bytes\":%llu}\n",
+            suffix.c_str(), n, index.termCount(), index.postingBytes(),
+            static_cast<unsigned long long>(fs::file_size(path)));
+
+        bench.run("index/search_word" + suffix, n, [&]() {
+            g_sink += index.search("director 7").size();
+            });
+        bench.run("index/search_prefix" + suffix, n, [&]() {
+            g_sink += index.search("dra").size();
+            });
+        bench.run("index/load" + suffix, n, [&]() {
+            MovieIndex loaded(path);
+            g_sink += loaded.load();
+            });
+    }
+}
+
+void benchEncode(Bench& bench) {
+    std::string shortQuery = "the matrix";
+    std::string longQuery = "Crouching Tiger, Hidden Dragon: Sword of Destiny (2016) & Friends - Director's Cut";
+
+    bench.run("encode_query/short", shortQuery.size(), [&]() {
+        g_sink += MovieSearchService::encode_query(shortQuery).size();
+        });
+    bench.run("encode_query/long", longQuery.size(), [&]() {
+        g_sink += MovieSearchService::encode_query(longQuery).size();
+        });
+}
+
+// Runs one streaming search and waits for the final callback
+size_t searchOnce(MovieSearchService& service, const std::string& query, const std::string& genre) {
+    struct Pending {
+        std::promise<size_t> done;
+        std::atomic<bool> finished{ false };
+    };
+    auto pending = std::make_shared<Pending>();
+    auto future = pending->done.get_future();
+    service.searchMovies(query, "", genre, false,
+        [pending](const std::vector<Movie>& results, StatusKind status) {
+            if (status == StatusKind::Searching || pending->finished.exchange(true)) return;
+            pending->done.set_value(results.size());
+        });
+    return future.get();
+}
+
+void benchNetwork(Bench& bench, const fs::path& dir) {
+    StubOmdbServer server(100);
+    if (!server.start()) {
+        std::cerr << "stub server failed to start, skipping network benchmarks" << std::endl;
+        return;
+    }
+
+    // The client is measured, not the api budget. Reads all 10 stub pages
+    auto unthrottle = [](MovieSearchService& service) {
+        service.setRateLimit(1e9, 1e9);
+        service.setDailyQuota(UINT32_MAX);
+        service.setMaxPages(10);
+    };
+
+    // Cold: fresh disk and memory caches, every page and detail goes to the stub
+    size_t run = 0;
+    bench.run("search/stub_cold", 100, [&]() {
+        MovieCache::instance().clear();
+        MovieSearchService service("127.0.0.1", server.port(), (dir / ("cache_" + std::to_string(run++))).string());
+        unthrottle(service);
+        g_sink += searchOnce(service, "Matrix", "");
+        });
+
+    bench.run("search/stub_cold_genre", 100, [&]() {
+        MovieCache::instance().clear();
+        MovieSearchService service("127.0.0.1", server.port(), (dir / ("cache_" + std::to_string(run++))).string());
+        unthrottle(service);
+        g_sink += searchOnce(service, "Matrix", "Drama");
+        });
+
+    // Warm: the same service again, answered from ResponseCache and MovieCache
+    MovieSearchService warm("127.0.0.1", server.port(), (dir / "cache_warm").string());
+    unthrottle(warm);
+    searchOnce(warm, "Matrix", "Drama");
+    bench.run("search/stub_warm_genre", 100, [&]() {
+        g_sink += searchOnce(warm, "Matrix", "Drama");
+        });
+
+    server.stop();
+
+    // Cost the limiter adds to every request that misses the cache (quota file included)
+    RateLimiter limiter((dir / "quota.txt").string(), 1e9, 1e9, UINT32_MAX);
+    CancellationToken token;
+    bench.run("network/limiter_acquire", 1, [&]() {
+        g_sink += limiter.acquire(TaskPriority::Normal, token);
+        });
+}
+
+}
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") quick = true;
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else {
+            std::cerr << "usage: movie_bench [--quick] [--filter <substring>]" << std::endl;
+            return 2;
+        }
+    }
+
+    fs::path dir = fs::temp_directory_path() / "movie_bench";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    Bench bench(quick ? 0.05 : 0.5, filter);
+    std::vector<size_t> sizes = quick ? std::vector<size_t>{ 10, 1000 } : std::vector<size_t>{ 10, 1000, 100000 };
+
+    benchParse(bench);
+    benchEncode(bench);
+    benchSort(bench, sizes);
+    benchFavorites(bench, sizes, dir);
+    benchIndex(bench, sizes, dir);
+    benchNetwork(bench, dir);
+
+    fs::remove_all(dir);
+    return 0;
+}
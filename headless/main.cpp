@@ -0,0 +1,278 @@
+// Headless workload driver for profiling and soak runs: searches, sorts and
+// favorites changes in a loop, no window and no Win32. Runs against a local
+// stub api by default, or a real endpoint with --host/--port.
+//
+//   movie_headless [--seconds N] [--report N] [--workload all|search|sort|favorites]
+//                  [--host H --port P] [--genre G] [--queries N] [--results N]
+//
+// Prints one JSON object per workload every --report seconds and at the end.
+
+#include "../bench/StubOmdbServer.h"
+#include "../MovieCache.h"
+#include "../MovieFavorites.h"
+#include "../MovieSearchService.h"
+#include "../movie_sort.h"
+#include "../movie_table.h"
+#include <json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    double seconds = 10.0;
+    double report = 0.0;            // 0 = only the final report
+    std::string workload = "all";
+    std::string host;               // empty = start the stub
+    int port = 80;
+    std::string genre = "Drama";    // every other search filters on it
+    size_t queries = 50;            // distinct queries, repeats hit the caches
+    size_t results = 100;           // stub hits per query
+};
+
+// Latencies of one workload
+struct Samples {
+    std::vector<double> ms;
+    uint64_t failures = 0;
+
+    json summary(const std::string& name) const {
+        std::vector<double> sorted = ms;
+        std::sort(sorted.begin(), sorted.end());
+        auto at = [&sorted](double q) {
+            return sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()))];
+        };
+        double total = 0.0;
+        for (double v : sorted) total += v;
+        return json{ {"workload", name}, {"ops", sorted.size()}, {"failures", failures},
+            {"mean_ms", sorted.empty() ? 0.0 : total / sorted.size()},
+            {"p50_ms", at(0.5)}, {"p99_ms", at(0.99)}, {"max_ms", sorted.empty() ? 0.0 : sorted.back()} };
+    }
+};
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Resident set in MB where the platform makes it cheap to read, for soak runs
+double residentMb() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (statm >> pages >> resident) return resident * 4096.0 / (1024.0 * 1024.0);
+#endif
+    return 0.0;
+}
+
+bool parseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seconds" && hasValue) options.seconds = std::atof(argv[++i]);
+        else if (arg == "--report" && hasValue) options.report = std::atof(argv[++i]);
+        else if (arg == "--workload" && hasValue) options.workload = argv[++i];
+        else if (arg == "--host" && hasValue) options.host = argv[++i];
+        else if (arg == "--port" && hasValue) options.port = std::atoi(argv[++i]);
+        else if (arg == "--genre" && hasValue) options.genre = argv[++i];
+        else if (arg == "--queries" && hasValue) options.queries = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--results" && hasValue) options.results = std::max(1, std::atoi(argv[++i]));
+        else return false;
+    }
+    return options.workload == "all" || options.workload == "search" ||
+        options.workload == "sort" || options.workload == "favorites";
+}
+
+class Driver {
+public:
+    Driver(const Options& options, MovieSearchService& service, const fs::path& dir)
+        : m_options(options), m_service(service),
+        m_favorites((dir / "favorites.json").string(), true), m_favoritesFile((dir / "favorites.json").string()) {}
+
+    void run() {
+        bool all = m_options.workload == "all";
+        auto start = Clock::now();
+        auto nextReport = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_options.report));
+
+        // Sort and favorites need movies, one search fills the pool first
+        if (m_options.workload != "search") search();
+
+        while (msSince(start) < m_options.seconds * 1000.0) {
+            if (all || m_options.workload == "search") search();
+            if (all || m_options.workload == "sort") sort();
+            if (all || m_options.workload == "favorites") favorites();
+
+            if (m_options.report > 0.0 && Clock::now() >= nextReport) {
+                report(msSince(start) / 1000.0);
+                nextReport += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_options.report));
+            }
+        }
+        report(msSince(start) / 1000.0);
+        verifyFavorites();
+    }
+
+private:
+    void search() {
+        std::string query = "movie" + std::to_string(m_round % m_options.queries);
+        std::string genre = m_round % 2 ? m_options.genre : "";
+        ++m_round;
+
+        // Shared with the callback, which can still run after a timed out wait returned
+        struct Pending {
+            std::promise<std::vector<Movie>> done;
+            std::atomic<bool> finished{ false };
+        };
+        auto pending = std::make_shared<Pending>();
+        auto future = pending->done.get_future();
+        auto start = Clock::now();
+        m_service.searchMovies(query, "", genre, false,
+            [pending](const std::vector<Movie>& results, StatusKind status) {
+                if (status == StatusKind::Searching || pending->finished.exchange(true)) return;
+                pending->done.set_value(results);
+            });
+
+        if (future.wait_for(std::chrono::seconds(30)) != std::future_status::ready) {
+            m_service.cancelSearch();
+            ++m_search.failures;
+            return;
+        }
+        m_search.ms.push_back(msSince(start));
+        for (const auto& movie : future.get()) {
+            m_seen[movie.imdb_id] = movie;
+        }
+    }
+
+    void sort() {
+        std::vector<Movie> movies;
+        movies.reserve(m_seen.size());
+        for (const auto& entry : m_seen) movies.push_back(entry.second);
+
+        // Every criterion both ways on a fresh table, as after a new result list
+        auto start = Clock::now();
+        MovieTable table;
+        table.assign(movies);
+        MovieSortIndex index;
+        size_t checksum = 0;
+        for (int c = 0; c < static_cast<int>(SortCriteria::Count); ++c) {
+            for (bool ascending : { true, false }) {
+                MovieOrder order = index.order(table, { SortKey{ static_cast<SortCriteria>(c), ascending } });
+                if (order.size()) checksum += order[0];
+            }
+        }
+        m_sort.ms.push_back(msSince(start));
+        m_checksum += checksum;     // keeps the orders alive
+    }
+
+    void favorites() {
+        if (m_seen.empty()) return;
+
+        // A few toggles, then every seen movie is looked up as a frame would
+        auto start = Clock::now();
+        for (int i = 0; i < 10; ++i) {
+            auto it = m_seen.begin();
+            std::advance(it, m_random() % m_seen.size());
+            m_favorites.toggleFavorite(it->second);
+            if (!m_expected.erase(it->first)) m_expected.insert(it->first);
+        }
+        size_t hits = 0;
+        for (const auto& entry : m_seen) {
+            hits += m_favorites.isFavorite(entry.first);
+        }
+        m_favoritesSamples.ms.push_back(msSince(start));
+        if (hits != m_expected.size()) ++m_favoritesSamples.failures;
+    }
+
+    void report(double elapsed) {
+        for (auto* entry : { &m_search, &m_sort, &m_favoritesSamples }) {
+            if (entry->ms.empty() && entry->failures == 0) continue;
+            const char* name = entry == &m_search ? "search" : entry == &m_sort ? "sort" : "favorites";
+            json line = entry->summary(name);
+            line["elapsed_s"] = elapsed;
+            line["movies_seen"] = m_seen.size();
+            line["rss_mb"] = residentMb();
+            std::cout << line.dump() << std::endl;
+        }
+    }
+
+    void verifyFavorites() {
+        if (m_favoritesSamples.ms.empty()) return;
+
+        // What reached the disk must be what was toggled
+        while (m_favorites.isSaving()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        MovieFavorites reloaded(m_favoritesFile, true);
+        std::promise<size_t> loaded;
+        reloaded.loadFavoritesAsync([&loaded](const std::vector<Movie>& movies) { loaded.set_value(movies.size()); });
+        size_t count = loaded.get_future().get();
+        std::cout << json{ {"workload", "favorites_reload"}, {"expected", m_expected.size()}, {"loaded", count},
+            {"consistent", count == m_expected.size()} }.dump() << std::endl;
+    }
+
+    const Options& m_options;
+    MovieSearchService& m_service;
+    MovieFavorites m_favorites;
+    std::string m_favoritesFile;
+    std::map<std::string, Movie> m_seen;        // every movie the searches returned
+    std::set<std::string> m_expected;           // favorites as toggled
+    std::mt19937 m_random{ 42 };
+    size_t m_round = 0;
+    size_t m_checksum = 0;
+
+    Samples m_search;
+    Samples m_sort;
+    Samples m_favoritesSamples;
+};
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "usage: movie_headless [--seconds N] [--report N] [--workload all|search|sort|favorites]\n"
+            "                      [--host H --port P] [--genre G] [--queries N] [--results N]" << std::endl;
+        return 2;
+    }
+
+    fs::path dir = fs::temp_directory_path() / "movie_headless";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    StubOmdbServer stub(options.results);
+    std::string host = options.host;
+    int port = options.port;
+    if (host.empty()) {
+        if (!stub.start()) {
+            std::cerr << "stub server failed to start" << std::endl;
+            return 1;
+        }
+        host = "127.0.0.1";
+        port = stub.port();
+    }
+
+    {
+        MovieSearchService service(host, port, (dir / "cache").string());
+        if (options.host.empty()) {     // the stub has no budget to protect, read every page
+            service.setRateLimit(1e9, 1e9);
+            service.setDailyQuota(UINT32_MAX);
+            service.setMaxPages((options.results + 9) / 10);
+        }
+        Driver driver(options, service, dir);
+        driver.run();
+    }
+
+    stub.stop();
+    fs::remove_all(dir);
+    return 0;
+}
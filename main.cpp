@@ -1,19 +1,27 @@
 #include "main_window.h"
 #include <iostream>
+#include <cstdlib>
+#include <string>
 
 
 //https://www.omdbapi.com/
 
 
-int main(int, char**) {
+int main(int argc, char** argv) {
     MainWindow window;  // imgui frame
 
+    // --max-fps N caps redraws while something changes, an idle window draws nothing
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--max-fps") window.setMaxFps(std::atof(argv[++i]));
+    }
+
     if (!window.init())     //start the frame
         return 1;
     bool done = false;
 
     while (!done) 
     {
+        window.waitForFrame();
         if (window.processMessages(done)) 
         {
             window.render();    //function that render the screen
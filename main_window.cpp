@@ -9,9 +9,13 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 // Store the MainWindow instance pointer for the static WndProc
 static MainWindow* g_MainWindowInstance = nullptr;
 
+// Posted by FrameScheduler wakeups from worker threads, only ends the wait
+static const UINT WM_APP_WAKE = WM_APP + 1;
+static const double kCursorBlinkSeconds = 0.4;     // ImGui blinks the text cursor at 0.8s on / 0.4s off
+
 MainWindow::MainWindow()
-    : m_hwnd(nullptr), m_hRC(nullptr), m_width(1280), m_height(800) {
-    m_app = std::make_unique<MovieSearchApp>();
+    : m_hwnd(nullptr), m_hRC(nullptr), m_width(1280), m_height(800), m_platform(m_frames) {
+    m_app = std::make_unique<MovieSearchApp>(m_platform);
     g_MainWindowInstance = this;  // Store instance for WndProc
 }
 
@@ -62,6 +66,9 @@ bool MainWindow::init() {
     ImGui_ImplWin32_InitForOpenGL(m_hwnd);
     ImGui_ImplOpenGL3_Init();
 
+    HWND hwnd = m_hwnd;
+    m_frames.setWakeHandler([hwnd]() { ::PostMessage(hwnd, WM_APP_WAKE, 0, 0); });
+
     return true;
 }
 
@@ -76,32 +83,51 @@ void MainWindow::cleanup() {
     ::UnregisterClassW(m_wc.lpszClassName, m_wc.hInstance);
 }
 
+void MainWindow::waitForFrame() {
+    // Minimized windows draw nothing, only a message can change that
+    auto wait = ::IsIconic(m_hwnd) ? FrameScheduler::Clock::duration::max() : m_frames.waitTime(FrameScheduler::Clock::now());
+    if (wait == FrameScheduler::Clock::duration::zero()) return;
+
+    DWORD timeout = INFINITE;
+    if (wait != FrameScheduler::Clock::duration::max()) {
+        // Rounded up, waking a millisecond early would just spin through another wait
+        timeout = static_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+    }
+    ::MsgWaitForMultipleObjectsEx(0, nullptr, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
+
 bool MainWindow::processMessages(bool& done) {
     MSG msg;
     while (::PeekMessage(&msg, nullptr, 0U, 0U, PM_REMOVE)) {
+        if (msg.message == WM_APP_WAKE) continue;   // the request is already in the scheduler
         ::TranslateMessage(&msg);
         ::DispatchMessage(&msg);
         if (msg.message == WM_QUIT) {
             done = true;
             return false;
         }
+        m_frames.onInput();     // also sizes, focus changes and WM_PAINT after the window is uncovered
     }
 
     if (::IsIconic(m_hwnd)) {
-        ::Sleep(10);
         return false;
     }
 
-    return true;
+    return m_frames.waitTime(FrameScheduler::Clock::now()) == FrameScheduler::Clock::duration::zero();
 }
 
 void MainWindow::render() {
+    m_frames.beginFrame(FrameScheduler::Clock::now());
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplWin32_NewFrame();
     ImGui::NewFrame();
 
     m_app->render();    //call for the render function in the app
 
+    if (ImGui::GetIO().WantTextInput) {
+        m_frames.requestFrameAfter(kCursorBlinkSeconds);
+    }
+
     ImGui::Render();
     glViewport(0, 0, m_width, m_height);
     glClearColor(0.45f, 0.55f, 0.60f, 1.00f);
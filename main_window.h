@@ -3,6 +3,8 @@
 #include <GL/GL.h>
 #include <memory> // Add this include for std::unique_ptr
 #include "movie_search_app.h"
+#include "Win32Platform.h"
+#include "FrameScheduler.h"
 
 
 struct WGL_WindowData { HDC hDC; };
@@ -14,8 +16,10 @@ public:
 
     bool init();
     void cleanup();
+    void waitForFrame();        // sleeps until input, a wakeup or a deadline
     bool processMessages(bool& done);
     void render();
+    void setMaxFps(double fps) { m_frames.setMaxFps(fps); }
 
     static LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
@@ -29,5 +33,7 @@ private:
     int m_width;
     int m_height;
     WNDCLASSEXW m_wc;
+    FrameScheduler m_frames;
+    Win32Platform m_platform;
     std::unique_ptr<MovieSearchApp> m_app;
 };
\ No newline at end of file
@@ -1,13 +1,43 @@
 ﻿#include "movie_search_app.h"
 #include "imgui.h"
-#include <httplib.h>
-#include <json.hpp>
-#include <windows.h>
+#include <unordered_set>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const double kSearchDebounceSeconds = 0.35;     // pause in typing before the network is asked
+const size_t kMinLiveQueryLength = 2;           // OMDB answers "Too many results" below that
+const int kMaxPrefetchInFlight = 3;             // speculative detail requests at a time
+const int kPrefetchPerFrame = 2;
+
+bool startsWithNoCase(const std::string& text, const std::string& prefix) {
+    return text.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), text.begin(),
+        [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b)); });
+}
 
-using json = nlohmann::json;
+// Every query word starts a word of the title
+bool titleMatches(const std::string& title, const std::vector<std::string>& words) {
+    std::vector<std::string> titleWords = MovieIndex::tokenize(title);
+    for (const auto& word : words) {
+        bool found = false;
+        for (const auto& titleWord : titleWords) {
+            if (titleWord.compare(0, word.size(), word) == 0) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+}
 
-MovieSearchApp::MovieSearchApp()
-    : isSearching(false), searchSingleMovie(false) {
+MovieSearchApp::MovieSearchApp(PlatformServices& platform)
+    : platform(platform), searchSingleMovie(false), isSearching(false) {
     memset(searchBuffer, 0, sizeof(searchBuffer));
     memset(yearBuffer, 0, sizeof(yearBuffer));
     memset(genreBuffer, 0, sizeof(genreBuffer));
@@ -16,98 +46,273 @@ MovieSearchApp::MovieSearchApp()
 MovieSearchApp::~MovieSearchApp() = default;
 
 
-int MovieSearchApp::extractRuntime(const std::string& runtime) {
-    try {
-        // Find the position of " min" and extract the numeric part before it
-        size_t minPos = runtime.find(" min");
-        if (minPos != std::string::npos) {
-            std::string runtimeStr = runtime.substr(0, minPos);  // Get the numeric part
-            return std::stoi(runtimeStr);  // Convert to integer and return
-        }
-    }
-    catch (const std::invalid_argument&) {
-        return 0;  // If conversion fails, return 0 (assumes invalid runtime)
+void MovieSearchApp::sortMovies() {
+    // Only the keys change here, render() looks the order up in sortIndex.
+    // "Ascending" lists the highest numbers first, as it always has
+    auto key = [](SortCriteria criteria, bool up) {
+        return SortKey{ criteria, criteria == SortCriteria::Title ? up : !up };
+    };
+
+    sortKeys.clear();
+    sortKeys.push_back(key(currentSortCriteria, ascending));
+    if (thenByCriteria != SortCriteria::Count && thenByCriteria != currentSortCriteria) {
+        sortKeys.push_back(key(thenByCriteria, true));
     }
-    return 0;  // Default if no valid runtime found
+
+    sortIndex.refresh(movies);  // pick up ratings and dates that arrived since the last sort
+    layoutDirty = true;         // open rows may have moved
 }
 
-void MovieSearchApp::sortMovies() {
-    // Launch the sorting in a separate thread to avoid blocking the UI
-    std::thread sortThread([this]()
-        {
-        std::lock_guard<std::mutex> lock(movieMutex);  // Protect shared data with mutex
-
-        switch (currentSortCriteria) {
-        case SortCriteria::Title:
-            std::sort(movies.begin(), movies.end(), [this](const Movie& a, const Movie& b) {
-                return ascending ? a.title < b.title : a.title > b.title;
-                });
-            break;
-        case SortCriteria::Year:
-            std::sort(movies.begin(), movies.end(), [this](const Movie& a, const Movie& b) {
-                try {
-                    return ascending ? std::stoi(a.year) > std::stoi(b.year) : std::stoi(a.year) < std::stoi(b.year);
-                }
-                catch (const std::invalid_argument&) {
-                    return false;  // Return false if conversion fails (invalid year)
-                }
-                });
-            break;
-        case SortCriteria::Rating:
-            std::sort(movies.begin(), movies.end(), [this](const Movie& a, const Movie& b) {
-                try {
-                    return ascending ? std::stof(a.rating) > std::stof(b.rating) : std::stof(a.rating) < std::stof(b.rating);
-                }
-                catch (const std::invalid_argument&) {
-                    return false;  // Return false if conversion fails (invalid rating)
+std::string MovieSearchApp::getSortCriteriaName(MovieSearchApp::SortCriteria criteria) {
+    if (criteria == SortCriteria::Count) return "None";
+    return sortCriteriaName(criteria);
+}
+
+void MovieSearchApp::showResults(const std::vector<Movie>& list, StatusKind status)
+{
+    searchPending = false;
+    searchService.cancelSearch();
+    searchService.cancelPrefetch();
+    shownQuery.clear();
+
+    auto snapshot = std::make_shared<ResultSnapshot>();
+    snapshot->generation = ++searchGeneration;
+    snapshot->table.assign(list);
+    published.publish(std::move(snapshot));
+    platform.requestFrame();
+
+    StatusEvent event;
+    event.kind = status;
+    event.generation = searchGeneration;
+    event.count = list.size();
+    setStatus(std::move(event));
+}
+
+void MovieSearchApp::setExpanded(const std::string& imdbId, bool expanded)
+{
+    if (expanded) openRows.emplace(imdbId, 0.0f);
+    else openRows.erase(imdbId);
+    layoutDirty = true;
+}
+
+void MovieSearchApp::setSort(SortCriteria criteria, bool ascendingOrder, SortCriteria thenBy)
+{
+    currentSortCriteria = criteria;
+    ascending = ascendingOrder;
+    thenByCriteria = thenBy;
+    sortMovies();
+}
+
+std::string MovieSearchApp::searchFilters() const {
+    return std::string(yearBuffer) + "|" + genreBuffer + "|" + (searchSingleMovie ? "t" : "s");
+}
+
+void MovieSearchApp::showLocalResults()
+{
+    searchService.cancelSearch();   // the running query is superseded
+    searchService.cancelPrefetch();
+
+    std::string query = searchBuffer;
+    std::string filters = searchFilters();
+    bool searchable = query.size() >= kMinLiveQueryLength;
+
+    std::vector<Movie> local;
+    if (searchable) {
+        local = searchService.searchLocal(query, yearBuffer, genreBuffer, searchSingleMovie);
+    }
+
+    {
+        ++searchGeneration;     // lists of older queries are dropped
+
+        // A longer query with the same filters only narrows the rows shown,
+        // they stay up (filtered) while the network catches up
+        if (searchable && !shownQuery.empty() && filters == shownFilters && startsWithNoCase(query, shownQuery)) {
+            std::vector<std::string> words = MovieIndex::tokenize(query);
+            std::unordered_set<std::string> seen;
+            for (const auto& movie : local) {
+                seen.insert(movie.imdb_id);
+            }
+            std::vector<Movie> refined;
+            for (size_t row = 0; row < movies.size(); ++row) {
+                MovieRef movie = movies.at(row);
+                if (!seen.count(movie.imdb_id.str()) && titleMatches(movie.title.str(), words)) {
+                    refined.push_back(movies.row(row));
                 }
-                });
-            break;
-        case SortCriteria::Released:
-            std::sort(movies.begin(), movies.end(), [this](const Movie& a, const Movie& b) {
-                // Extract the last 4 characters of the 'released' string to get the year
-                std::string yearA = a.released.length() >= 4 ? a.released.substr(a.released.length() - 4) : "0000";
-                std::string yearB = b.released.length() >= 4 ? b.released.substr(b.released.length() - 4) : "0000";
-                return ascending ? yearA > yearB : yearA < yearB;  // Compare years as strings
-                });
-            break;
-        case SortCriteria::Runtime:
-            std::sort(movies.begin(), movies.end(), [this](const Movie& a, const Movie& b) {
-                int runtimeA = extractRuntime(a.runtime);
-                int runtimeB = extractRuntime(b.runtime);
-                return ascending ? runtimeA > runtimeB : runtimeA < runtimeB;  // Sort by runtime
-                });
-            break;
+            }
+            local.insert(local.end(), refined.begin(), refined.end());
         }
-        });
+        movies.assign(local);
+    }
+
+    shownQuery = searchable ? query : "";
+    shownFilters = filters;
+    searchPending = searchable;
+    searchDueTime = ImGui::GetTime() + kSearchDebounceSeconds;
 
-    // Detach the thread to let it run independently
-    sortThread.detach();
+    StatusEvent event;
+    event.kind = !searchable ? StatusKind::None : (local.empty() ? StatusKind::Searching : StatusKind::LocalMatches);
+    event.generation = searchGeneration;
+    event.count = local.size();
+    setStatus(std::move(event));
 }
 
-std::string MovieSearchApp::getSortCriteriaName(MovieSearchApp::SortCriteria criteria) {
-    switch (criteria) {
-    case SortCriteria::Title: return "Title";
-    case SortCriteria::Year: return "Year";
-    case SortCriteria::Rating: return "Rating";
-    case SortCriteria::Released: return "Released";
-    case SortCriteria::Runtime: return "Runtime";
+void MovieSearchApp::startSearch()
+{
+    searchPending = false;
+
+    // Rows already shown for this query stay, the network results are merged in as they arrive
+    std::vector<Movie> local = movies.rows();
+    uint64_t generation = searchGeneration;
+    std::string query = searchBuffer;
+    auto started = StatusEvent::Clock::now();
+    if (statusKind == StatusKind::None) {
+        StatusEvent event;
+        event.kind = StatusKind::Searching;
+        event.generation = generation;
+        setStatus(std::move(event));
+    }
+
+    searchService.searchMovies(
+        searchBuffer,
+        yearBuffer,
+        genreBuffer,
+        searchSingleMovie,
+		[this, local, generation, query, started](const std::vector<Movie>& results, StatusKind status)    // Callback lambda function done after search
+        {
+            // The table is built here on the worker, the UI only swaps it in
+            auto snapshot = std::make_shared<ResultSnapshot>();
+            snapshot->generation = generation;
+            snapshot->table.reserve(results.size() + local.size());
+            std::unordered_set<std::string> seen;
+            for (const auto& movie : results) {
+                seen.insert(movie.imdb_id);
+                snapshot->table.append(movie);
+            }
+            for (const auto& movie : local) {
+                if (!seen.count(movie.imdb_id)) snapshot->table.append(movie);
+            }
+
+            // Rows found locally still count when the api had nothing or failed
+            StatusEvent event;
+            event.kind = status != StatusKind::Searching && !snapshot->table.empty() ? StatusKind::SearchDone : status;
+            event.generation = generation;
+            event.count = snapshot->table.size();
+            event.text = query;
+            event.latency = StatusEvent::Clock::now() - started;
+
+            published.publish(std::move(snapshot));
+            postStatus(std::move(event));   // after the list, a frame that sees the status also gets the list
+        });
+}
 
-    default: return "";
+void MovieSearchApp::applyPublished()
+{
+    // Events first: workers publish a list before its status event
+    drainedEvents.clear();
+    if (statusEvents.drain(drainedEvents) > 0) {
+        for (const auto& event : drainedEvents) {
+            applyStatus(event);
+        }
     }
+
+    // Lists are only taken for the current query, a newer query owns the table
+    std::shared_ptr<ResultSnapshot> snapshot = published.take();
+    if (snapshot && snapshot->generation == searchGeneration) {
+        movies = std::move(snapshot->table);    // new version, sortIndex re-sorts on this frame
+    }
+
+    // Details that arrived for rows of any list, only this thread touches the table
+    detailUpdates.clear();
+    if (rowUpdates.drain(detailUpdates)) {
+        for (const auto& movie : detailUpdates) {
+            if (movies.updateDetails(movie)) detailsFailed.insert(movie.imdb_id);     // no automatic retry every frame
+        }
+    }
+}
+
+void MovieSearchApp::setStatus(StatusEvent event)
+{
+    event.time = StatusEvent::Clock::now();
+    applyStatus(event);
 }
 
+void MovieSearchApp::postStatus(StatusEvent event)
+{
+    statusEvents.push(std::move(event));
+    platform.requestFrame();
+}
+
+void MovieSearchApp::applyStatus(const StatusEvent& event)
+{
+    activityLog.add(event);
+
+    // Events of a superseded query are only logged
+    if (!isStatusLine(event.kind)) return;
+    if (event.generation != 0 && event.generation != searchGeneration) return;
+    statusKind = event.kind;
+    statusLine = describe(event);
+}
+
+void MovieSearchApp::renderActivityLog()
+{
+    ImGui::SetNextWindowSize(ImVec2(520, 300), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Activity", &showActivityLog)) {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::Button("Clear log")) activityLog.clear();
+    if (statusEvents.dropped() > 0) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("%llu events dropped", static_cast<unsigned long long>(statusEvents.dropped()));
+    }
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable;
+    if (ImGui::BeginTable("ActivityLog", 4, flags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Event", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Query / title");
+        ImGui::TableSetupColumn("Latency", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+
+        // Newest first, seconds since the app started
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(activityLog.size()));
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const StatusLog::Entry& entry = activityLog.at(activityLog.size() - 1 - i);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", std::chrono::duration<double>(entry.time - startTime).count());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(entry.message.c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(entry.text.c_str());
+                ImGui::TableNextColumn();
+                if (entry.latency.count() > 0) {
+                    ImGui::Text("%.1f ms", std::chrono::duration<double, std::milli>(entry.latency).count());
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
 
 void MovieSearchApp::render() 
 {
+    applyPublished();
+
     ImGui::SetNextWindowSize(ImVec2(800, 600), ImGuiCond_FirstUseEver);
     ImGui::Begin("Movie Search", nullptr);
 
     // Search layout with title and year inputs
     ImGui::PushItemWidth(200); // Leave space for year input and search button
-    if (ImGui::InputText("search", searchBuffer, sizeof(searchBuffer),
-        ImGuiInputTextFlags_EnterReturnsTrue)) {
-    }
+    bool searchEdited = false;
+    bool searchNow = ImGui::InputText("search", searchBuffer, sizeof(searchBuffer),
+        ImGuiInputTextFlags_EnterReturnsTrue);     // Enter searches without waiting
+    searchEdited |= ImGui::IsItemEdited();
     if (ImGui::IsItemHovered()) {
         ImGui::SetTooltip("Enter movie title to search");
     }
@@ -120,6 +325,7 @@ void MovieSearchApp::render()
     bool validYear = true;
     if (ImGui::InputText("Year", yearBuffer, sizeof(yearBuffer), ImGuiInputTextFlags_CharsDecimal)) //Optinal input year 
     {
+        searchEdited = true;
         // Validate year input
         if (strlen(yearBuffer) > 0) {
             try {
@@ -153,6 +359,7 @@ void MovieSearchApp::render()
     ImGui::PushItemWidth(120);
 	if (ImGui::InputText("Genre", genreBuffer, sizeof(genreBuffer))) // Optional genre input
     {
+        searchEdited = true;
         // Convert input to title case for display
         if (strlen(genreBuffer) > 0) {
             genreBuffer[0] = toupper(genreBuffer[0]);
@@ -165,34 +372,58 @@ void MovieSearchApp::render()
     ImGui::PopItemWidth();
 
     ImGui::SameLine();
-	ImGui::Checkbox("Exact Title", &searchSingleMovie); // Optional checkbox for exact title search
+	searchEdited |= ImGui::Checkbox("Exact Title", &searchSingleMovie); // Optional checkbox for exact title search
     if (ImGui::IsItemHovered()) 
     {
         ImGui::SetTooltip("Optional: Search for exact movie title match");
     }
 
     ImGui::SameLine();
-	if (ImGui::Button("Search") && !searchService.isSearching() && strlen(searchBuffer) > 0)  // Search button
+    ImGui::Checkbox("As you type", &liveSearch);
+    if (ImGui::IsItemHovered())
     {
-		statusMessage = "Searching...";
-        searchService.searchMovies(
-            searchBuffer,
-            yearBuffer,
-            genreBuffer,
-            searchSingleMovie,
-			[this](const std::vector<Movie>& results, const std::string& status)    // Callback lambda function done after search
-            {
-                std::lock_guard<std::mutex> lock(movieMutex);
-                movies = results;
-                statusMessage = status;
-                sortMovies();
-            });
+        ImGui::SetTooltip("Search while typing, shortly after the last key");
     }
 
+    ImGui::SameLine();
+	searchNow |= ImGui::Button("Search");  // Search button, a new search replaces the running one
     if (ImGui::IsItemHovered())
     {
         ImGui::SetTooltip("Search");
     }
+
+    if (searchNow && strlen(searchBuffer) > 0)
+    {
+        // Movies seen before show up at once, the network results are merged in as they arrive
+        showLocalResults();
+        startSearch();
+    }
+    else if (searchEdited && liveSearch)
+    {
+        showLocalResults();     // the network is asked once typing pauses
+    }
+    else if (searchPending && (!liveSearch || ImGui::GetTime() >= searchDueTime))
+    {
+        if (liveSearch) startSearch();
+        else searchPending = false;
+    }
+    else if (searchPending)
+    {
+        platform.requestFrameAfter(searchDueTime - ImGui::GetTime());  // nothing else may draw a frame before the debounce ends
+    }
+
+    if (searchService.isSearching())    // Stop button, keeps the pages that already arrived
+    {
+        ImGui::SameLine();
+        if (ImGui::Button("Stop"))
+        {
+            searchPending = false;
+            searchService.cancelSearch();
+            StatusEvent event;
+            event.kind = StatusKind::SearchStopped;
+            setStatus(std::move(event));
+        }
+    }
     ImGui::PushItemWidth(70);
 
 
@@ -222,6 +453,21 @@ void MovieSearchApp::render()
 
         ImGui::EndCombo();
     }
+    ImGui::SameLine();
+
+    // Optional secondary key for ties in the first one
+    if (ImGui::BeginCombo("Then by", getSortCriteriaName(thenByCriteria).c_str()))
+    {
+        for (int i = 0; i <= static_cast<int>(SortCriteria::Count); ++i) {
+            SortCriteria criteria = static_cast<SortCriteria>(i);
+            if (ImGui::Selectable(getSortCriteriaName(criteria).c_str(), thenByCriteria == criteria)) {
+                thenByCriteria = criteria;
+                sortMovies();
+            }
+        }
+
+        ImGui::EndCombo();
+    }
 	ImGui::SameLine();
     ImGui::PushItemWidth(70);
 
@@ -238,12 +484,31 @@ void MovieSearchApp::render()
 
 	if (ImGui::Button("Load Favorites"))  // Load favorites button
     {
-		statusMessage = "Loading favorites...";
-        favorites.loadFavoritesAsync([this](const std::vector<Movie>& favMovies) 
+        searchPending = false;
+        searchService.cancelSearch();
+        searchService.cancelPrefetch();
+        uint64_t generation = ++searchGeneration;  // a late search result must not replace the favorites
+        shownQuery.clear();
+
+        StatusEvent loading;
+        loading.kind = StatusKind::FavoritesLoading;
+        loading.generation = generation;
+        setStatus(std::move(loading));
+
+        auto started = StatusEvent::Clock::now();
+        favorites.loadFavoritesAsync([this, generation, started](const std::vector<Movie>& favMovies) 
             {
-            std::lock_guard<std::mutex> lock(movieMutex);
-            movies = favMovies;
-            statusMessage = "Loaded " + std::to_string(movies.size()) + " favorite movies";
+            auto snapshot = std::make_shared<ResultSnapshot>();
+            snapshot->generation = generation;
+            snapshot->table.assign(favMovies);
+            published.publish(std::move(snapshot));
+
+            StatusEvent event;
+            event.kind = StatusKind::FavoritesLoaded;
+            event.generation = generation;
+            event.count = favMovies.size();
+            event.latency = StatusEvent::Clock::now() - started;
+            postStatus(std::move(event));
             });
     }
     if (ImGui::IsItemHovered())
@@ -271,148 +536,317 @@ void MovieSearchApp::render()
 	// Clear button
     if (ImGui::Button("clear"))
     {
-        {
-            std::lock_guard<std::mutex> lock(movieMutex);
-            movies.clear();
-        }
+        searchPending = false;
+        searchService.cancelSearch();
+        searchService.cancelPrefetch();
+        ++searchGeneration;
+        movies.clear();
+        shownQuery.clear();
         memset(searchBuffer, 0, sizeof(searchBuffer));
         memset(yearBuffer, 0, sizeof(yearBuffer));
         memset(genreBuffer, 0, sizeof(genreBuffer));
         searchSingleMovie = false;
-        statusMessage = "";
+        setStatus(StatusEvent());
     }
     if (ImGui::IsItemHovered())
     {
         ImGui::SetTooltip("Clear the screen");
     }
 
+    ImGui::SameLine();
+    if (ImGui::Button("Activity"))
+    {
+        showActivityLog = !showActivityLog;
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Recent searches, loads and details with their latencies");
+    }
+
+    // Api budget left today, throttled requests are answered from the cache
+    RateLimiterStats quota = searchService.quotaStats();
+    ImGui::SameLine();
+    ImGui::TextDisabled("Requests left today: %u/%u", quota.remainingToday, quota.dailyLimit);
+
 
     // Status message with appropriate color
-    if (!statusMessage.empty()) {
+    if (statusKind != StatusKind::None) {
+        static const ImVec4 toneColors[] = {
+            ImVec4(1.0f, 1.0f, 0.0f, 1.0f),     // Busy
+            ImVec4(0.0f, 1.0f, 0.0f, 1.0f),     // Done
+            ImVec4(0.0f, 1.0f, 1.0f, 1.0f),     // Info
+            ImVec4(1.0f, 0.0f, 0.0f, 1.0f)      // Error
+        };
         ImGui::Spacing();
-        if (statusMessage.find("Found") != std::string::npos)
-        {
-            ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", statusMessage.c_str());
-        }
-        else if (statusMessage == "Searching...") {
-            ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", statusMessage.c_str());
+        ImGui::TextColored(toneColors[static_cast<int>(statusTone(statusKind))], "%s", statusLine.c_str());
+        ImGui::Separator();
+    }
+
+
+    if (!movies.empty())  //update the movies
+    {
+		ImGui::BeginChild("Results", ImVec2(0, 0), true);   // Begin scrolling region
+        renderResults();
+        ImGui::EndChild();
+    }
+    ImGui::End();
+
+    if (showActivityLog) renderActivityLog();
+}
+
+void MovieSearchApp::renderResults()
+{
+    // Collapsed rows all have the same height, so
+    // runs of them go through ImGuiListClipper and only the visible ones are
+    // submitted. Expanded rows are drawn when on screen, otherwise their last
+    // measured height is skipped with a Dummy
+    MovieOrder order = sortIndex.order(movies, sortKeys);  // cached, rebuilt only when rows change
+
+    if (layoutDirty || layoutVersion != movies.version()) {
+        rowOpen.assign(movies.size(), 0);
+        openPositions.clear();
+        if (!openRows.empty()) {
+            for (size_t row = 0; row < movies.size(); ++row) {
+                if (openRows.count(movies.at(row).imdb_id.str())) rowOpen[row] = 1;
+            }
+            for (size_t position = 0; position < order.size(); ++position) {
+                if (rowOpen[order[position]]) openPositions.push_back(position);
+            }
         }
-        else if (statusMessage.find("Loaded") != std::string::npos) {
-            ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", statusMessage.c_str());
+        layoutVersion = movies.version();
+        layoutDirty = false;
+    }
+
+    const float rowHeight = ImGui::GetFrameHeightWithSpacing();
+    const float viewTop = ImGui::GetScrollY();
+    const float viewBottom = viewTop + ImGui::GetWindowHeight();
+    visibleFirst = order.size();
+    visibleEnd = 0;
+    auto drawn = [this](size_t position) {
+        visibleFirst = std::min(visibleFirst, position);
+        visibleEnd = std::max(visibleEnd, position + 1);
+    };
+
+    size_t position = 0;
+    auto collapsedRun = [&](size_t end) {
+        if (end <= position) return;
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(end - position), rowHeight);
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                renderMovieRow(order[position + i]);
+                drawn(position + i);
+            }
         }
-        else if (statusMessage.find("Loading favorites...") != std::string::npos)
-        {
-             ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Loading favorites...");
+        position = end;
+    };
+
+    for (size_t openPosition : openPositions) {
+        collapsedRun(openPosition);
+
+        size_t row = order[openPosition];
+        std::string id = movies.at(row).imdb_id.str();
+        float top = ImGui::GetCursorPosY();
+        auto open = openRows.find(id);
+        float height = open != openRows.end() ? open->second : 0.0f;
+        if (height > 0.0f && (top + height < viewTop || top > viewBottom)) {
+            ImGui::Dummy(ImVec2(0.0f, height - ImGui::GetStyle().ItemSpacing.y));
         }
-		else if (statusMessage.find("Update favorites") != std::string::npos)
-		{
-            ImGui::TextColored(ImVec4(0.0f, 1.0f, 1.0f, 1.0f), "Update favorites...");
-		}
-		else if (statusMessage.find("favorites updated") != std::string::npos)
-		{
-			ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "favorites updated");
-		}
-        else
-        {
-            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", statusMessage.c_str());
+        else {
+            renderMovieRow(row);
+            drawn(openPosition);
+            open = openRows.find(id);   // closing the header removes it
+            if (open != openRows.end()) open->second = ImGui::GetCursorPosY() - top;
         }
-        ImGui::Separator();
+        position = openPosition + 1;
     }
+    collapsedRun(order.size());
 
+    schedulePrefetch(order);
+}
 
-    {   //update the movies
-        std::lock_guard<std::mutex> lock(movieMutex);
-
-        if (!movies.empty())
-        {
-			ImGui::BeginChild("Results", ImVec2(0, 0), true);   // Begin scrolling region
+void MovieSearchApp::schedulePrefetch(const MovieOrder& order)
+{
+    // Details for the rows on screen and the ones about to scroll in, nearest
+    // first, a page and a half ahead in the scroll direction and half a page
+    // behind. Opening a row promotes its request to High in the service
+    if (visibleEnd <= visibleFirst) return;
+    if (prefetchGeneration != searchGeneration) {
+        prefetchGeneration = searchGeneration;
+        prefetchRequested.clear();
+    }
 
-            for (auto& movie : movies) 
+    size_t page = visibleEnd - visibleFirst;
+    bool up = visibleFirst < lastVisibleFirst;
+    lastVisibleFirst = visibleFirst;
+    size_t ahead = page + page / 2;
+    size_t behind = page / 2;
+    size_t first = visibleFirst - std::min(visibleFirst, up ? ahead : behind);
+    size_t end = std::min(order.size(), visibleEnd + (up ? behind : ahead));
+
+    int issued = 0;
+    auto consider = [&](size_t position) {
+        if (issued >= kPrefetchPerFrame || prefetchInFlight >= kMaxPrefetchInFlight) return false;
+        size_t row = order[position];
+        if (movies.hasDetails(row) || movies.isFetching(row)) return true;
+        if (!prefetchRequested.insert(movies.at(row).imdb_id.str()).second) return true;
+
+        ++prefetchInFlight;
+        ++issued;
+        auto started = StatusEvent::Clock::now();
+        searchService.prefetchDetails(movies.row(row), [this, started](const Movie& result)
             {
-				std::string headerLabel = movie.title + " (" + movie.year + ")";    // Display title and year
-                if (movie.type != "movie") {
-                    headerLabel += " [" + movie.type + "]";
+                --prefetchInFlight;
+                if (!result.hasDetails) {   // a dropped prefetch is not a failure
+                    platform.requestFrame();    // a free slot lets the next frame prefetch more
+                    return;
                 }
-                headerLabel += "##" + movie.imdb_id;
+                rowUpdates.post(result);
 
-                bool header_open = ImGui::CollapsingHeader(headerLabel.c_str());
+                StatusEvent event;
+                event.kind = StatusKind::DetailsPrefetched;
+                event.text = result.title;
+                event.latency = StatusEvent::Clock::now() - started;
+                postStatus(std::move(event));
+            });
+        return true;
+    };
 
-                // Load details automatically when header is opened
-                if (header_open && !movie.hasDetails && !movie.fetching) 
-                {
-                    searchService.fetchMovieDetails(movie, [this](const Movie& updatedMovie) {});
-                }
+    for (size_t position = visibleFirst; position < visibleEnd; ++position) {
+        if (!consider(position)) return;
+    }
+    if (up) {
+        for (size_t position = visibleFirst; position-- > first; ) if (!consider(position)) return;
+        for (size_t position = visibleEnd; position < end; ++position) if (!consider(position)) return;
+    }
+    else {
+        for (size_t position = visibleEnd; position < end; ++position) if (!consider(position)) return;
+        for (size_t position = visibleFirst; position-- > first; ) if (!consider(position)) return;
+    }
+}
 
-                if (header_open) 
-                {
-                    ImGui::Indent(20);
-
-                    // Show loading indicator or details
-                    if (!movie.hasDetails) {
-                        ImGui::Text("Loading details...");
-                    }
-                    else
-                    {
-                        if (!movie.rating.empty() && movie.rating != "N/A")
-                            ImGui::TextColored(ImVec4(1.0f, 0.843f, 0.0f, 1.0f), "Rating: %s", movie.rating.c_str());
-                        if (!movie.released.empty() && movie.released != "N/A")
-                            ImGui::TextColored(ImVec4(0.678f, 0.847f, 0.902f, 1.0f), "Released: %s", movie.released.c_str());
-                        if (!movie.director.empty() && movie.director != "N/A")
-                            ImGui::TextWrapped("Director: %s", movie.director.c_str());
-                        if (!movie.genre.empty() && movie.genre != "N/A")
-                            ImGui::TextWrapped("Genre: %s", movie.genre.c_str());
-                        if (!movie.runtime.empty() && movie.runtime != "N/A")
-                            ImGui::Text("Runtime: %s", movie.runtime.c_str());
-                        ImGui::Spacing();
-                        if (!movie.actors.empty() && movie.actors != "N/A")
-                            ImGui::TextWrapped("Cast: %s", movie.actors.c_str());
-
-                        if (!movie.plot.empty() && movie.plot != "N/A") {
-                            ImGui::Spacing();
-                            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.8f, 0.8f, 0.8f, 1.0f));
-                            ImGui::TextWrapped("Plot: %s", movie.plot.c_str());
-                            ImGui::PopStyleColor();
-                        }
-                    }
-
-                    ImGui::Spacing();
-
-                    std::string imdbButtonId = "IMDB Page##" + movie.imdb_id;
-					if (ImGui::Button(imdbButtonId.c_str()))  // Open IMDB page button
-                    {
-                        std::string url = "https://imdb.com/title/" + movie.imdb_id;
-                        ShellExecuteA(NULL, "open", url.c_str(), NULL, NULL, SW_SHOWNORMAL);
-                    }
-
-                    if (movie.poster_url != "N/A") {
-                        ImGui::SameLine();
-                        std::string posterButtonId = "View Poster##" + movie.imdb_id;
-						if (ImGui::Button(posterButtonId.c_str()))  //Open poster button
-                        {
-                            ShellExecuteA(NULL, "open", movie.poster_url.c_str(), NULL, NULL, SW_SHOWNORMAL);
-                        }
-                    }
-
-                    ImGui::SameLine();
-                    std::string favButtonLabel = (favorites.isFavorite(movie.imdb_id) ?
-                        "Remove from Favorites" : "Add to Favorites");
-                    favButtonLabel += "##" + movie.imdb_id;
-                    if (ImGui::Button(favButtonLabel.c_str()))  // Add/remove favorites button
-                    {
-						statusMessage = "Update favorites";
-                        favorites.toggleFavorite(movie);
-						statusMessage = "favorites updated";
-                    }
-                    ImGui::Unindent(20);
-                    ImGui::Separator();
-                }
-                if (ImGui::IsItemHovered())
-                {
-                    ImGui::SetTooltip(movie.title.c_str());
-                }
+void MovieSearchApp::renderMovieRow(size_t row)
+{
+    MovieRef movie = movies.at(row);
+    ImGui::PushID(movie.imdb_id.c_str());   // ids come from the imdb_id, labels can be truncated
+
+    // Display title and year, formatted into one buffer reused by every row
+    if (movie.type != "movie") {
+        snprintf(rowLabel, sizeof(rowLabel), "%s (%s) [%s]", movie.title.c_str(), movie.year.c_str(), movie.type.c_str());
+    }
+    else {
+        snprintf(rowLabel, sizeof(rowLabel), "%s (%s)", movie.title.c_str(), movie.year.c_str());
+    }
+
+    // Open state is kept by imdb_id, so it survives new result lists
+    bool wasOpen = rowOpen[row] != 0;
+    ImGui::SetNextItemOpen(wasOpen);
+    bool header_open = ImGui::CollapsingHeader(rowLabel);
+    if (header_open != wasOpen) {
+        if (header_open) openRows[movie.imdb_id.str()] = 0.0f;
+        else openRows.erase(movie.imdb_id.str());
+        layoutDirty = true;
+    }
+
+    // Load details automatically when header is opened
+    bool failed = header_open && !movie.hasDetails && detailsFailed.count(movie.imdb_id.str());
+    if (header_open && !movie.hasDetails && !movie.fetching && !failed) 
+    {
+        Movie request = movies.row(row);
+        auto started = StatusEvent::Clock::now();
+        searchService.fetchMovieDetails(request, [this, started](const Movie& updatedMovie)
+            {
+                rowUpdates.post(updatedMovie);      // applied by the next frame, the list may have changed by then
+
+                StatusEvent event;
+                event.kind = updatedMovie.hasDetails ? StatusKind::DetailsLoaded : StatusKind::DetailsFailed;
+                event.text = updatedMovie.title;
+                event.latency = StatusEvent::Clock::now() - started;
+                postStatus(std::move(event));
+            });
+        if (request.hasDetails) {
+            movies.updateDetails(row, request);     // details from the cache
+        }
+        else {
+            movies.setFetching(row, true);
+        }
+        movie = movies.at(row);
+    }
+
+    if (header_open) 
+    {
+        ImGui::Indent(20);
+
+        // Show loading indicator or details
+        if (failed) {
+            ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Details unavailable (offline or request limit reached)");
+            ImGui::SameLine();
+            if (ImGui::Button("Retry")) {
+                detailsFailed.erase(movie.imdb_id.str());
+            }
+        }
+        else if (!movie.hasDetails) {
+            ImGui::Text("Loading details...");
+        }
+        else
+        {
+            if (!movie.rating.empty() && movie.rating != "N/A")
+                ImGui::TextColored(ImVec4(1.0f, 0.843f, 0.0f, 1.0f), "Rating: %s", movie.rating.c_str());
+            if (!movie.released.empty() && movie.released != "N/A")
+                ImGui::TextColored(ImVec4(0.678f, 0.847f, 0.902f, 1.0f), "Released: %s", movie.released.c_str());
+            if (!movie.director.empty() && movie.director != "N/A")
+                ImGui::TextWrapped("Director: %s", movie.director.c_str());
+            if (!movie.genre.empty() && movie.genre != "N/A")
+                ImGui::TextWrapped("Genre: %s", movie.genre.c_str());
+            if (!movie.runtime.empty() && movie.runtime != "N/A")
+                ImGui::Text("Runtime: %s", movie.runtime.c_str());
+            ImGui::Spacing();
+            if (!movie.actors.empty() && movie.actors != "N/A")
+                ImGui::TextWrapped("Cast: %s", movie.actors.c_str());
+
+            if (!movie.plot.empty() && movie.plot != "N/A") {
+                ImGui::Spacing();
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.8f, 0.8f, 0.8f, 1.0f));
+                ImGui::TextWrapped("Plot: %s", movie.plot.c_str());
+                ImGui::PopStyleColor();
+            }
+        }
+
+        ImGui::Spacing();
+
+		if (ImGui::Button("IMDB Page"))  // Open IMDB page button
+        {
+            std::string url = "https://imdb.com/title/" + movie.imdb_id.str();
+            platform.openUrl(url);
+        }
+
+        if (movie.poster_url != "N/A") {
+            ImGui::SameLine();
+			if (ImGui::Button("View Poster"))  //Open poster button
+            {
+                platform.openUrl(movie.poster_url.str());
             }
-            ImGui::EndChild();
         }
+
+        ImGui::SameLine();
+        const char* favButtonLabel = (favorites.isFavorite(movie.imdb_id.str()) ?
+            "Remove from Favorites" : "Add to Favorites");
+        if (ImGui::Button(favButtonLabel))  // Add/remove favorites button
+        {
+            auto started = StatusEvent::Clock::now();
+            StatusEvent event;
+            event.kind = favorites.isFavorite(movie.imdb_id.str()) ? StatusKind::FavoriteRemoved : StatusKind::FavoriteAdded;
+            event.text = movie.title.str();
+            favorites.toggleFavorite(movies.row(row));
+            event.latency = StatusEvent::Clock::now() - started;
+            setStatus(std::move(event));
+        }
+        ImGui::Unindent(20);
+        ImGui::Separator();
     }
-    ImGui::End();
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("%s", movie.title.c_str());
+    }
+    ImGui::PopID();
 }
\ No newline at end of file
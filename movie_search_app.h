@@ -2,45 +2,89 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
 #include "movie.h"
-#include <mutex>
+#include "movie_table.h"
+#include "movie_sort.h"
+#include "ResultMailbox.h"
+#include "StatusEvents.h"
 #include "MovieFavorites.h"
 #include "MovieSearchService.h"
+#include "PlatformServices.h"
 #include "imgui.h"
 
 class MovieSearchApp {
 public:
-    MovieSearchApp();   //constractur
+    explicit MovieSearchApp(PlatformServices& platform);   //constractur, platform must outlive the app
     ~MovieSearchApp();
     void render();
 
-    enum class SortCriteria 
-    {
-        Title,
-        Year,
-        Rating,
-        Released,
-        Runtime
-    };
+    using SortCriteria = ::SortCriteria;
     SortCriteria currentSortCriteria = SortCriteria::Title; // Default sort by Title
+    SortCriteria thenByCriteria = SortCriteria::Count;      // secondary key, Count = none
 
     bool ascending = true;  // true for ascending, false for descending
 
     bool isDarkTheme = true;
 
+    // Scripted runs (headless frame benchmarks) drive these instead of clicks.
+    // Call them on the thread that renders, the list shows from the next frame
+    void showResults(const std::vector<Movie>& list, StatusKind status = StatusKind::SearchDone);
+    void setExpanded(const std::string& imdbId, bool expanded);
+    void setSort(SortCriteria criteria, bool ascendingOrder, SortCriteria thenBy = SortCriteria::Count);
 
 private:
-    // Mutex to protect shared resources
-    std::mutex movieMutex;
+    PlatformServices& platform;     // url opening, Win32 or headless
 
     void sortMovies();
-	int extractRuntime(const std::string& runtime);
 	std::string getSortCriteriaName(SortCriteria criteria);
 
+    // Search as you type
+    void showLocalResults();    // instant matches for the current inputs, arms the debounce
+    void startSearch();         // network search, merged with the rows shown now
+    std::string searchFilters() const;
+    void applyPublished();      // swaps in lists, details and status events the workers finished
+
+    // Status line and activity log
+    void setStatus(StatusEvent event);          // UI thread
+    void postStatus(StatusEvent event);         // worker threads, shown by the next frame
+    void applyStatus(const StatusEvent& event);
+    void renderActivityLog();
+
+    // Results list, only the visible rows are submitted
+    void renderResults();
+    void renderMovieRow(size_t row);
+    void schedulePrefetch(const MovieOrder& order);
+
 
     std::string ApiKey = "fb4a2231";
 
-    std::vector<Movie> movies;  //vector that save the current movies
+    // Workers never touch the table: they build whole lists off-thread and
+    // publish them, or post per-row details. Only the UI thread reads and writes movies
+    ResultMailbox published;
+    RowUpdates rowUpdates;
+    std::vector<Movie> detailUpdates;   // drained each frame, keeps its capacity
+    std::unordered_set<std::string> detailsFailed;     // fetched without details, retried on request
+
+    MovieTable movies;  //columnar table that save the current movies
+    MovieSortIndex sortIndex;       // display order of movies, the table itself is never sorted
+    std::vector<SortKey> sortKeys{ SortKey{ SortCriteria::Title, true } };
+
+    std::unordered_map<std::string, float> openRows;   // imdb_id -> height of the expanded row, 0 until drawn
+    std::vector<uint8_t> rowOpen;           // per table row, rebuilt when the rows or the order change
+    std::vector<size_t> openPositions;      // display positions of the open rows, ascending
+    uint64_t layoutVersion = 0;             // movies.version() the two above were built for
+    bool layoutDirty = true;
+    char rowLabel[512];                     // header label, formatted for one row at a time
+
+    size_t visibleFirst = 0;                // display positions drawn this frame
+    size_t visibleEnd = 0;
+    size_t lastVisibleFirst = 0;            // last frame's, gives the scroll direction
+    std::unordered_set<std::string> prefetchRequested;  // imdb_ids already asked for in this list
+    uint64_t prefetchGeneration = 0;
+    std::atomic<int> prefetchInFlight{ 0 };
 
     //search inputs
     char searchBuffer[256];
@@ -50,10 +94,25 @@ private:
 
     bool isSearching;
 
-    std::string statusMessage;
+    bool liveSearch = true;         // search while typing
+    bool searchPending = false;     // an edit waits for the debounce
+    double searchDueTime = 0.0;     // ImGui time the pending search starts
+    uint64_t searchGeneration = 0;  // bumped for every new query, lists carry the one they were built for
+    std::string shownQuery;         // inputs of the rows in movies, to refine them locally
+    std::string shownFilters;
+
+    // Typed status from every thread, the status line text and color are
+    // built once per event, not matched every frame
+    StatusChannel statusEvents;
+    std::vector<StatusEvent> drainedEvents;     // drained each frame, keeps its capacity
+    StatusLog activityLog;
+    StatusEvent::Clock::time_point startTime = StatusEvent::Clock::now();    // log times count from here
+    StatusKind statusKind = StatusKind::None;
+    std::string statusLine;
+    bool showActivityLog = false;
 
     //service for save favorites
-    MovieFavorites favorites;
+    MovieFavorites favorites;     // favorites.json, the binary snapshot is opt-in
     //service for do search
     MovieSearchService searchService;
 };
@@ -0,0 +1,124 @@
+#include "movie_sort.h"
+#include <algorithm>
+
+namespace {
+
+bool isMissing(const MovieTable& table, SortCriteria criteria, uint32_t row) {
+    switch (criteria) {
+    case SortCriteria::Year: return table.yearValue(row) == MovieTable::kMissing;
+    case SortCriteria::Rating: return table.ratingValue(row) < 0.0f;
+    case SortCriteria::Released: return table.releasedDate(row) == MovieTable::kMissing;
+    case SortCriteria::Runtime: return table.runtimeMinutes(row) == MovieTable::kMissing;
+    default: return false;
+    }
+}
+
+// -1, 0 or 1 on the parsed columns, both rows must have a value
+int compareValues(const MovieTable& table, SortCriteria criteria, uint32_t a, uint32_t b) {
+    auto sign = [](auto x, auto y) { return x < y ? -1 : (y < x ? 1 : 0); };
+
+    switch (criteria) {
+    case SortCriteria::Title:
+        return sign(table.strings().view(table.titleId(a)), table.strings().view(table.titleId(b)));
+    case SortCriteria::Year: return sign(table.yearValue(a), table.yearValue(b));
+    case SortCriteria::Rating: return sign(table.ratingValue(a), table.ratingValue(b));
+    case SortCriteria::Released: return sign(table.releasedDate(a), table.releasedDate(b));
+    case SortCriteria::Runtime: return sign(table.runtimeMinutes(a), table.runtimeMinutes(b));
+    default: return 0;
+    }
+}
+
+}
+
+const char* sortCriteriaName(SortCriteria criteria) {
+    switch (criteria) {
+    case SortCriteria::Title: return "Title";
+    case SortCriteria::Year: return "Year";
+    case SortCriteria::Rating: return "Rating";
+    case SortCriteria::Released: return "Released";
+    case SortCriteria::Runtime: return "Runtime";
+    default: return "";
+    }
+}
+
+void MovieSortIndex::clear() {
+    for (auto& index : m_single) {
+        index = Index();
+    }
+    m_multi.clear();
+}
+
+void MovieSortIndex::build(const MovieTable& table, const std::vector<SortKey>& keys, Index& index) const {
+    const SortCriteria primary = keys.front().criteria;
+
+    // Rows with a primary value first, "N/A" rows keep their table order at the end
+    index.rows.clear();
+    index.rows.reserve(table.size());
+    for (uint32_t row = 0; row < table.size(); ++row) {
+        if (!isMissing(table, primary, row)) index.rows.push_back(row);
+    }
+    index.validCount = index.rows.size();
+    for (uint32_t row = 0; row < table.size(); ++row) {
+        if (isMissing(table, primary, row)) index.rows.push_back(row);
+    }
+
+    // A strict weak ordering: missing secondary values sort last, full ties keep the table order
+    std::stable_sort(index.rows.begin(), index.rows.begin() + index.validCount,
+        [&table, &keys](uint32_t a, uint32_t b) {
+            for (const SortKey& key : keys) {
+                bool missingA = isMissing(table, key.criteria, a);
+                bool missingB = isMissing(table, key.criteria, b);
+                if (missingA || missingB) {
+                    if (missingA != missingB) return missingB;
+                    continue;
+                }
+
+                int result = compareValues(table, key.criteria, a, b);
+                if (result != 0) return key.ascending ? result < 0 : result > 0;
+            }
+            return false;
+        });
+
+    index.built = true;
+}
+
+void MovieSortIndex::refresh(const MovieTable& table) {
+    if (&table == m_table && table.detailsVersion() != m_detailsVersion) {
+        clear();
+        m_detailsVersion = table.detailsVersion();
+    }
+}
+
+MovieOrder MovieSortIndex::order(const MovieTable& table, const std::vector<SortKey>& keys) {
+    if (&table != m_table || table.version() != m_tableVersion) {
+        clear();
+        m_table = &table;
+        m_tableVersion = table.version();
+        m_detailsVersion = table.detailsVersion();
+    }
+
+    if (keys.empty() || table.empty()) {
+        static const std::vector<uint32_t> none;
+        return MovieOrder(&none, 0, false);
+    }
+
+    if (keys.size() == 1) {
+        Index& index = m_single[static_cast<int>(keys.front().criteria)];
+        if (!index.built) {
+            build(table, { SortKey{ keys.front().criteria, true } }, index);
+        }
+        return MovieOrder(&index.rows, index.validCount, !keys.front().ascending);
+    }
+
+    std::string signature;
+    for (const SortKey& key : keys) {
+        signature += static_cast<char>('0' + static_cast<int>(key.criteria));
+        signature += key.ascending ? '+' : '-';
+    }
+
+    Index& index = m_multi[signature];
+    if (!index.built) {
+        build(table, keys, index);
+    }
+    return MovieOrder(&index.rows, index.validCount, false);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "movie_table.h"
+
+enum class SortCriteria
+{
+    Title,
+    Year,
+    Rating,
+    Released,
+    Runtime,
+    Count
+};
+
+const char* sortCriteriaName(SortCriteria criteria);
+
+struct SortKey {
+    SortCriteria criteria;
+    bool ascending;
+};
+
+// Display order of a table: position -> row. Rows without a value for the
+// primary key ("N/A") always come last, whatever the direction.
+class MovieOrder {
+public:
+    MovieOrder() = default;
+    MovieOrder(const std::vector<uint32_t>* rows, size_t validCount, bool reversed)
+        : m_rows(rows), m_validCount(validCount), m_reversed(reversed) {}
+
+    size_t size() const { return m_rows ? m_rows->size() : 0; }
+
+    uint32_t operator[](size_t position) const {
+        if (!m_reversed || position >= m_validCount) return (*m_rows)[position];
+        return (*m_rows)[m_validCount - 1 - position];
+    }
+
+private:
+    const std::vector<uint32_t>* m_rows = nullptr;
+    size_t m_validCount = 0;
+    bool m_reversed = false;
+};
+
+// Permutation indices over a MovieTable. The table itself is never moved.
+// Every criterion keeps one ascending index, so a single key in either
+// direction is a cached lookup. Multi-key orders are cached per key list.
+// Caches are dropped when rows change; details arriving for a row only
+// re-sort on refresh(), so rows don't jump while the user reads them.
+class MovieSortIndex {
+public:
+    MovieOrder order(const MovieTable& table, const std::vector<SortKey>& keys);
+    void refresh(const MovieTable& table);  // re-sort if any details changed since the last build
+    void clear();
+
+private:
+    struct Index {
+        std::vector<uint32_t> rows;
+        size_t validCount = 0;
+        bool built = false;
+    };
+
+    void build(const MovieTable& table, const std::vector<SortKey>& keys, Index& index) const;
+
+    const MovieTable* m_table = nullptr;
+    uint64_t m_tableVersion = 0;
+    uint64_t m_detailsVersion = 0;
+    Index m_single[static_cast<int>(SortCriteria::Count)];
+    std::unordered_map<std::string, Index> m_multi;
+};
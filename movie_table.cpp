@@ -0,0 +1,299 @@
+#include "movie_table.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+uint64_t hashText(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;    // FNV-1a
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+}
+
+// ---------------------------------------------------------------- StringPool
+
+StringPool::StringPool() {
+    rehash(64);
+    intern("");     // id 0 is the empty string
+}
+
+size_t StringPool::slotFor(std::string_view text, uint64_t hash) const {
+    size_t mask = m_slots.size() - 1;
+    size_t slot = static_cast<size_t>(hash) & mask;
+    while (m_slots[slot] != 0 && view(m_slots[slot] - 1) != text) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void StringPool::rehash(size_t slotCount) {
+    m_slots.assign(slotCount, 0);
+    for (Id id = 0; id < m_offsets.size(); ++id) {
+        m_slots[slotFor(view(id), hashText(view(id)))] = id + 1;
+    }
+}
+
+bool StringPool::find(std::string_view text, Id& id) const {
+    size_t slot = slotFor(text, hashText(text));
+    if (m_slots[slot] == 0) return false;
+    id = m_slots[slot] - 1;
+    return true;
+}
+
+StringPool::Id StringPool::intern(std::string_view text) {
+    uint64_t hash = hashText(text);
+    size_t slot = slotFor(text, hash);
+    if (m_slots[slot] != 0) return m_slots[slot] - 1;
+
+    Id id = static_cast<Id>(m_offsets.size());
+    m_offsets.push_back(static_cast<uint32_t>(m_blob.size()));
+    m_lengths.push_back(static_cast<uint32_t>(text.size()));
+    m_blob.insert(m_blob.end(), text.begin(), text.end());
+    m_blob.push_back('\0');
+    m_slots[slot] = id + 1;
+
+    if (m_offsets.size() * 2 > m_slots.size()) {    // keep the load factor under 1/2
+        rehash(m_slots.size() * 2);
+    }
+    return id;
+}
+
+size_t StringPool::memoryBytes() const {
+    return m_blob.capacity() + (m_offsets.capacity() + m_lengths.capacity() + m_slots.capacity()) * sizeof(uint32_t);
+}
+
+// ---------------------------------------------------------------- parsing
+
+int MovieTable::parseYear(std::string_view text) {
+    // "1999", also series ranges like "2010-2015" or "2010-", only the first year counts
+    if (text.size() < 4) return kMissing;
+    int year = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i]))) return kMissing;
+        year = year * 10 + (text[i] - '0');
+    }
+    return year;
+}
+
+float MovieTable::parseRating(std::string_view text) {
+    // "7.5"
+    float value = 0.0f;
+    float scale = 0.0f;
+    bool digits = false;
+    for (char c : text) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            digits = true;
+            if (scale == 0.0f) {
+                value = value * 10.0f + (c - '0');
+            }
+            else {
+                value += (c - '0') * scale;
+                scale *= 0.1f;
+            }
+        }
+        else if (c == '.' && scale == 0.0f) {
+            scale = 0.1f;
+        }
+        else {
+            return static_cast<float>(kMissing);
+        }
+    }
+    return digits ? value : static_cast<float>(kMissing);
+}
+
+int MovieTable::parseRuntime(std::string_view text) {
+    // "136 min"
+    int minutes = 0;
+    size_t i = 0;
+    for (; i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])); ++i) {
+        minutes = minutes * 10 + (text[i] - '0');
+    }
+    if (i == 0 || text.substr(i, 4) != " min") return kMissing;
+    return minutes;
+}
+
+int MovieTable::parseReleased(std::string_view text) {
+    // "31 Mar 1999"
+    static const char* months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+    if (text.size() != 11 || text[2] != ' ' || text[6] != ' ') return kMissing;
+    if (!std::isdigit(static_cast<unsigned char>(text[0])) || !std::isdigit(static_cast<unsigned char>(text[1]))) return kMissing;
+
+    int day = (text[0] - '0') * 10 + (text[1] - '0');
+    int month = 0;
+    for (int m = 0; m < 12; ++m) {
+        if (text.substr(3, 3) == months[m]) month = m + 1;
+    }
+    int year = parseYear(text.substr(7));
+    if (month == 0 || year == kMissing) return kMissing;
+    return year * 10000 + month * 100 + day;
+}
+
+// ---------------------------------------------------------------- MovieTable
+
+uint64_t MovieTable::nextVersion() {
+    // Globally unique stamps, so a cleared or replaced table never reuses an old version
+    static std::atomic<uint64_t> counter{ 1 };
+    return counter++;
+}
+
+void MovieTable::clear() {
+    *this = MovieTable();
+    m_version = nextVersion();
+}
+
+void MovieTable::reserve(size_t rows) {
+    for (auto& column : m_text) column.reserve(rows);
+    m_year.reserve(rows);
+    m_rating.reserve(rows);
+    m_runtime.reserve(rows);
+    m_released.reserve(rows);
+    m_flags.reserve(rows);
+}
+
+void MovieTable::assign(const std::vector<Movie>& movies) {
+    clear();
+    reserve(movies.size());
+    for (const auto& movie : movies) {
+        append(movie);
+    }
+}
+
+void MovieTable::setText(Field field, size_t row, const std::string& value) {
+    m_text[field][row] = m_strings.intern(value);
+}
+
+void MovieTable::parseColumns(size_t row) {
+    m_year[row] = static_cast<int16_t>(parseYear(m_strings.view(m_text[Year][row])));
+    m_rating[row] = parseRating(m_strings.view(m_text[Rating][row]));
+    m_runtime[row] = static_cast<int16_t>(parseRuntime(m_strings.view(m_text[Runtime][row])));
+    m_released[row] = parseReleased(m_strings.view(m_text[Released][row]));
+}
+
+size_t MovieTable::append(const Movie& movie) {
+    size_t row = size();
+    for (auto& column : m_text) column.push_back(0);
+    m_year.push_back(kMissing);
+    m_rating.push_back(static_cast<float>(kMissing));
+    m_runtime.push_back(kMissing);
+    m_released.push_back(kMissing);
+    m_flags.push_back(0);
+    m_version = nextVersion();
+
+    setText(Title, row, movie.title);
+    setText(Year, row, movie.year);
+    setText(ImdbId, row, movie.imdb_id);
+    setText(PosterUrl, row, movie.poster_url);
+    setText(Type, row, movie.type);
+    updateDetails(row, movie);
+    return row;
+}
+
+void MovieTable::updateDetails(size_t row, const Movie& movie) {
+    setText(Actors, row, movie.actors);
+    setText(Plot, row, movie.plot);
+    setText(Rating, row, movie.rating);
+    setText(Director, row, movie.director);
+    setText(Genre, row, movie.genre);
+    setText(Runtime, row, movie.runtime);
+    setText(Released, row, movie.released);
+    parseColumns(row);
+    m_detailsVersion = nextVersion();
+
+    m_flags[row] = (movie.fetching ? kFetching : 0) | (movie.hasDetails ? kHasDetails : 0);
+}
+
+bool MovieTable::updateDetails(const Movie& movie) {
+    StringPool::Id id;
+    if (!m_strings.find(movie.imdb_id, id)) return false;
+
+    bool missing = false;
+    const auto& ids = m_text[ImdbId];
+    for (size_t row = 0; row < ids.size(); ++row) {
+        if (ids[row] != id) continue;
+        if (!movie.hasDetails && hasDetails(row)) {
+            setFetching(row, false);    // a failed fetch keeps the details the row already shows
+            continue;
+        }
+        updateDetails(row, movie);
+        missing |= !movie.hasDetails;
+    }
+    return missing;
+}
+
+MovieRef MovieTable::at(size_t row) const {
+    return MovieRef{
+        m_strings.text(m_text[Title][row]),
+        m_strings.text(m_text[Year][row]),
+        m_strings.text(m_text[ImdbId][row]),
+        m_strings.text(m_text[Actors][row]),
+        m_strings.text(m_text[PosterUrl][row]),
+        m_strings.text(m_text[Plot][row]),
+        m_strings.text(m_text[Rating][row]),
+        m_strings.text(m_text[Director][row]),
+        m_strings.text(m_text[Genre][row]),
+        m_strings.text(m_text[Runtime][row]),
+        m_strings.text(m_text[Type][row]),
+        m_strings.text(m_text[Released][row]),
+        isFetching(row),
+        hasDetails(row)
+    };
+}
+
+Movie MovieTable::row(size_t row) const {
+    MovieRef ref = at(row);
+    Movie movie;
+    movie.title = ref.title.str();
+    movie.year = ref.year.str();
+    movie.imdb_id = ref.imdb_id.str();
+    movie.actors = ref.actors.str();
+    movie.poster_url = ref.poster_url.str();
+    movie.plot = ref.plot.str();
+    movie.rating = ref.rating.str();
+    movie.director = ref.director.str();
+    movie.genre = ref.genre.str();
+    movie.runtime = ref.runtime.str();
+    movie.type = ref.type.str();
+    movie.released = ref.released.str();
+    movie.fetching = ref.fetching;
+    movie.hasDetails = ref.hasDetails;
+    return movie;
+}
+
+std::vector<Movie> MovieTable::rows() const {
+    std::vector<Movie> movies;
+    movies.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+        movies.push_back(row(i));
+    }
+    return movies;
+}
+
+int MovieTable::find(const std::string& imdbId) const {
+    StringPool::Id id;
+    if (!m_strings.find(imdbId, id)) return -1;
+
+    const auto& ids = m_text[ImdbId];
+    auto it = std::find(ids.begin(), ids.end(), id);
+    return it == ids.end() ? -1 : static_cast<int>(it - ids.begin());
+}
+
+void MovieTable::setFetching(size_t row, bool fetching) {
+    if (fetching) m_flags[row] |= kFetching;
+    else m_flags[row] &= ~kFetching;
+}
+
+size_t MovieTable::memoryBytes() const {
+    size_t bytes = m_strings.memoryBytes();
+    for (const auto& column : m_text) bytes += column.capacity() * sizeof(StringPool::Id);
+    bytes += m_year.capacity() * sizeof(int16_t) + m_runtime.capacity() * sizeof(int16_t);
+    bytes += m_rating.capacity() * sizeof(float) + m_released.capacity() * sizeof(int32_t);
+    bytes += m_flags.capacity();
+    return bytes;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "movie.h"
+
+// Append-only pool of interned strings. All strings live in one blob with
+// '\0' terminators, ids are dense and stable for the life of the pool.
+class StringPool {
+public:
+    using Id = uint32_t;
+
+    // Non-owning reference to a pooled string, valid until the next intern()
+    struct Text {
+        const char* ptr;
+        uint32_t length;
+
+        const char* c_str() const { return ptr; }
+        bool empty() const { return length == 0; }
+        std::string_view view() const { return std::string_view(ptr, length); }
+        std::string str() const { return std::string(ptr, length); }
+
+        friend bool operator==(Text a, const char* b) { return a.view() == b; }
+        friend bool operator!=(Text a, const char* b) { return a.view() != b; }
+    };
+
+    StringPool();
+
+    Id intern(std::string_view text);
+    bool find(std::string_view text, Id& id) const;     // lookup without inserting
+
+    Text text(Id id) const { return Text{ m_blob.data() + m_offsets[id], m_lengths[id] }; }
+    std::string_view view(Id id) const { return std::string_view(m_blob.data() + m_offsets[id], m_lengths[id]); }
+
+    size_t size() const { return m_offsets.size(); }
+    size_t memoryBytes() const;
+
+private:
+    size_t slotFor(std::string_view text, uint64_t hash) const;
+    void rehash(size_t slotCount);
+
+    std::vector<char> m_blob;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint32_t> m_lengths;
+    std::vector<uint32_t> m_slots;      // open addressing over ids, id + 1 (0 = empty)
+};
+
+// Read-only view of one table row, field names match Movie
+struct MovieRef {
+    StringPool::Text title;
+    StringPool::Text year;
+    StringPool::Text imdb_id;
+    StringPool::Text actors;
+    StringPool::Text poster_url;
+    StringPool::Text plot;
+    StringPool::Text rating;
+    StringPool::Text director;
+    StringPool::Text genre;
+    StringPool::Text runtime;
+    StringPool::Text type;
+    StringPool::Text released;
+    bool fetching;
+    bool hasDetails;
+};
+
+// Columnar store for result lists. Text fields are interned into one
+// StringPool (types, genres, directors and "N/A" repeat a lot), the fields
+// used for sorting are parsed once at ingest into typed columns.
+class MovieTable {
+public:
+    static constexpr int kMissing = -1;     // parsed value for "N/A" and unparsable text
+
+    size_t size() const { return m_flags.size(); }
+    bool empty() const { return m_flags.empty(); }
+    uint64_t version() const { return m_version; }                 // rows added, removed or moved
+    uint64_t detailsVersion() const { return m_detailsVersion; }   // parsed columns of a row changed
+    void clear();
+    void reserve(size_t rows);
+
+    void assign(const std::vector<Movie>& movies);
+    size_t append(const Movie& movie);
+    void updateDetails(size_t row, const Movie& movie);
+    // Every row with movie.imdb_id, true when one of them still lacks details.
+    // Rows that have details only lose kFetching to an update without them
+    bool updateDetails(const Movie& movie);
+
+    MovieRef at(size_t row) const;
+    Movie row(size_t row) const;
+    std::vector<Movie> rows() const;
+    int find(const std::string& imdbId) const;          // first row or -1
+
+    void setFetching(size_t row, bool fetching);
+    bool isFetching(size_t row) const { return (m_flags[row] & kFetching) != 0; }
+    bool hasDetails(size_t row) const { return (m_flags[row] & kHasDetails) != 0; }
+
+    // Parsed columns, kMissing when the text had no value
+    int yearValue(size_t row) const { return m_year[row]; }
+    float ratingValue(size_t row) const { return m_rating[row]; }
+    int runtimeMinutes(size_t row) const { return m_runtime[row]; }
+    int releasedDate(size_t row) const { return m_released[row]; }     // yyyymmdd
+    StringPool::Id titleId(size_t row) const { return m_text[Title][row]; }
+    const StringPool& strings() const { return m_strings; }
+
+    size_t memoryBytes() const;
+
+    static int parseYear(std::string_view text);
+    static float parseRating(std::string_view text);
+    static int parseRuntime(std::string_view text);
+    static int parseReleased(std::string_view text);
+
+private:
+    enum Field { Title, Year, ImdbId, Actors, PosterUrl, Plot, Rating, Director, Genre, Runtime, Type, Released, FieldCount };
+    enum Flag : uint8_t { kFetching = 1, kHasDetails = 2 };
+
+    void setText(Field field, size_t row, const std::string& value);
+    void parseColumns(size_t row);
+    static uint64_t nextVersion();
+
+    uint64_t m_version = 0;
+    uint64_t m_detailsVersion = 0;
+
+    StringPool m_strings;
+    std::vector<StringPool::Id> m_text[FieldCount];
+    std::vector<int16_t> m_year;
+    std::vector<float> m_rating;
+    std::vector<int16_t> m_runtime;
+    std::vector<int32_t> m_released;
+    std::vector<uint8_t> m_flags;
+};